@@ -0,0 +1,48 @@
+#include "calculator/batch_calculator.hpp"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+std::vector<std::string> makeExpressions(size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> digit(1, 99);
+    const char ops[] = {'+', '-', '*', '/'};
+    std::vector<std::string> expressions;
+    expressions.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string expression = "(" + std::to_string(digit(rng));
+        for (int term = 0; term < 8; term++) {
+            expression += ops[digit(rng) % 4];
+            expression += std::to_string(digit(rng));
+        }
+        expression += ")^2";
+        expressions.push_back(std::move(expression));
+    }
+    return expressions;
+}
+
+// Throughput of one large batch as the pool grows from 1 thread to every hardware thread
+void BM_BatchCalculatorScaling(benchmark::State& state) {
+    static const auto expressions = makeExpressions(100000);
+    BatchCalculator batch(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(batch.calculate(expressions));
+    }
+    state.SetItemsProcessed(state.iterations() * expressions.size());
+}
+
+void threadCounts(benchmark::internal::Benchmark* benchmark) {
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        benchmark->Arg(threads);
+    }
+    benchmark->Arg(maxThreads);
+}
+} // namespace
+
+BENCHMARK(BM_BatchCalculatorScaling)->Apply(threadCounts)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,48 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/function_sampler.hpp"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+// A plot wide enough for a large window, with poles and steep regions that trigger refinement
+constexpr size_t kPlotWidth = 2048;
+constexpr const char* kExpression = "x^3 / (x^2 - 4) + 1 / (x - 0.3)";
+
+FunctionSampler makeSampler() {
+    CalculatorCore calc;
+    return FunctionSampler(calc.compile(kExpression));
+}
+
+// A frame that samples the view from scratch, as on the first draw or after a large zoom
+void BM_SampleColdView(benchmark::State& state) {
+    std::vector<FunctionSampler::Point> points;
+    uint64_t evaluated = 0;
+    for (auto _ : state) {
+        FunctionSampler sampler = makeSampler();
+        sampler.sample(-10.0, 10.0, kPlotWidth, points);
+        evaluated += sampler.samplesEvaluated();
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.counters["samples_per_frame"] = static_cast<double>(evaluated) / state.iterations();
+    state.counters["points"] = static_cast<double>(points.size());
+}
+
+// A frame while dragging: the view moves a few pixels and only newly exposed tiles are evaluated
+void BM_SamplePanningView(benchmark::State& state) {
+    FunctionSampler sampler = makeSampler();
+    std::vector<FunctionSampler::Point> points;
+    const double pixel = 20.0 / kPlotWidth;
+    double offset = 0.0;
+    for (auto _ : state) {
+        sampler.sample(-10.0 + offset, 10.0 + offset, kPlotWidth, points);
+        offset += 4 * pixel;
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.counters["samples_per_frame"] = static_cast<double>(sampler.samplesEvaluated()) / state.iterations();
+}
+} // namespace
+
+BENCHMARK(BM_SampleColdView)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SamplePanningView)->Unit(benchmark::kMicrosecond);
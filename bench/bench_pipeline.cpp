@@ -0,0 +1,195 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator_core_peer.hpp"
+#include "corpus.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+using Token = CalculatorCorePeer::Token;
+
+/**
+ * @brief Expression for a benchmark case: range(0) selects the shape, range(1) its size
+ */
+enum Shape { Random = 0, RandomPower = 1, Nested = 2, Chain = 3 };
+
+std::string makeExpression(const benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(1));
+    switch (state.range(0)) {
+    case Random:
+        return corpus::randomExpression(size, 4, corpus::OperatorMix::Mixed);
+    case RandomPower:
+        return corpus::randomExpression(size, 4, corpus::OperatorMix::WithPower);
+    case Nested:
+        return corpus::deepParentheses(size);
+    default:
+        return corpus::longChain(size);
+    }
+}
+
+void setCounters(benchmark::State& state, const std::string& expression, size_t tokens) {
+    state.SetBytesProcessed(state.iterations() * expression.size());
+    state.counters["tokens"] = static_cast<double>(tokens);
+    state.counters["tokens_per_second"] =
+        benchmark::Counter(static_cast<double>(tokens * state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void BM_Tokenize(benchmark::State& state) {
+    CalculatorCore calc;
+    auto expression = makeExpression(state);
+    std::vector<Token> tokens;
+    for (auto _ : state) {
+        CalculatorCorePeer::tokenize(calc, expression, tokens);
+        benchmark::DoNotOptimize(tokens.data());
+    }
+    setCounters(state, expression, tokens.size());
+}
+
+void BM_ShuntingYard(benchmark::State& state) {
+    CalculatorCore calc;
+    auto expression = makeExpression(state);
+    std::vector<Token> tokens, rpn, ops;
+    CalculatorCorePeer::tokenize(calc, expression, tokens);
+    for (auto _ : state) {
+        CalculatorCorePeer::shuntingYard(calc, tokens, rpn, ops);
+        benchmark::DoNotOptimize(rpn.data());
+    }
+    setCounters(state, expression, tokens.size());
+}
+
+void BM_EvaluatePostfix(benchmark::State& state) {
+    CalculatorCore calc;
+    auto expression = makeExpression(state);
+    std::vector<Token> tokens, rpn, ops;
+    std::vector<double> values;
+    CalculatorCorePeer::tokenize(calc, expression, tokens);
+    CalculatorCorePeer::shuntingYard(calc, tokens, rpn, ops);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CalculatorCorePeer::evaluatePostfix(calc, rpn, values));
+    }
+    setCounters(state, expression, tokens.size());
+}
+
+// Same program as BM_EvaluatePostfix, run by the bytecode interpreter; unoptimized, since these
+// expressions have no variables and would fold to a single constant
+void BM_CompiledEvaluate(benchmark::State& state) {
+    CalculatorCore calc;
+    auto expression = makeExpression(state);
+    std::vector<Token> tokens;
+    CalculatorCorePeer::tokenize(calc, expression, tokens);
+    auto compiled = calc.compile(expression, {false});
+    const std::vector<double> values;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compiled.tryEvaluate(values));
+    }
+    setCounters(state, expression, tokens.size());
+}
+
+// Formulas mixing variables with constant subexpressions; range(0) toggles the optimizer
+void BM_CompiledFormula(benchmark::State& state) {
+    static const char* const kFormulas[] = {
+        "(2^10)*x/4 - y*1 + 0",
+        "0.5 * 9.81 * t^2 + v * t * (1 + 0) - (3 * 4 - 2)",
+        "(x - 1.5)^2 / (2 * 0.25^2) + (y - 2.5)^2 / (2 * 0.25^2)",
+    };
+    CalculatorCore calc;
+    CompileOptions options{state.range(0) != 0};
+    std::vector<CompiledExpression> formulas;
+    size_t saved = 0;
+    for (const char* formula : kFormulas) {
+        formulas.push_back(calc.compile(formula, options));
+        saved += formulas.back().opsSaved();
+    }
+    const std::vector<double> values{1.25, 3.5};
+    for (auto _ : state) {
+        for (const auto& formula : formulas) {
+            benchmark::DoNotOptimize(formula.tryEvaluate(values));
+        }
+    }
+    state.counters["ops_saved"] = static_cast<double>(saved);
+    state.SetItemsProcessed(state.iterations() * formulas.size());
+}
+
+// The same reduction over two variables as a chain of '+' (range(0) = 0), of nested max() calls (1), which
+// compile to a dedicated opcode, or of nested calls to a registered equivalent of max (2), which go through
+// the callback, to compare function calls with a built-in operator on the interpreter's hot path
+void BM_CompiledCall(benchmark::State& state) {
+    constexpr int kOperations = 64;
+    const char* const kCallee[] = {"", "max(", "larger("};
+    std::string expression = "x";
+    for (int i = 0; i < kOperations; i++) {
+        const char* operand = i % 2 == 0 ? "y" : "x";
+        expression = state.range(0) == 0 ? expression + "+" + operand
+                                         : kCallee[state.range(0)] + expression + "," + operand + ")";
+    }
+    CalculatorCore calc;
+    calc.registerFunction("larger", 2, [](const double* a) { return std::fmax(a[0], a[1]); });
+    auto compiled = calc.compile(expression);
+    const std::vector<double> values{1.25, 3.5};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compiled.tryEvaluate(values));
+    }
+    state.SetItemsProcessed(state.iterations() * kOperations);
+}
+
+template <CalculatorCore::Engine engine>
+void BM_Calculate(benchmark::State& state) {
+    CalculatorCore calc;
+    calc.setEngine(engine);
+    auto expression = makeExpression(state);
+    std::vector<Token> tokens;
+    CalculatorCorePeer::tokenize(calc, expression, tokens);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.calculate(expression));
+    }
+    setCounters(state, expression, tokens.size());
+}
+
+// A realistic traffic mix, evaluated end to end
+template <CalculatorCore::Engine engine>
+void BM_CalculateMixedCorpus(benchmark::State& state) {
+    CalculatorCore calc;
+    calc.setEngine(engine);
+    const auto expressions = corpus::mixedCorpus(1024);
+    size_t bytes = 0;
+    for (const auto& expression : expressions) {
+        bytes += expression.size();
+    }
+    for (auto _ : state) {
+        for (const auto& expression : expressions) {
+            benchmark::DoNotOptimize(calc.calculate(expression));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * expressions.size());
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void pipelineCases(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"shape", "size"});
+    for (int64_t size : {4, 16, 64, 256}) {
+        benchmark->Args({Random, size});
+        benchmark->Args({RandomPower, size});
+    }
+    // Pathological inputs: deep parentheses and 100k-token flat expressions
+    for (int64_t depth : {64, 1024, 16384}) {
+        benchmark->Args({Nested, depth});
+    }
+    for (int64_t tokens : {1000, 100000}) {
+        benchmark->Args({Chain, tokens});
+    }
+}
+} // namespace
+
+BENCHMARK(BM_Tokenize)->Apply(pipelineCases);
+BENCHMARK(BM_ShuntingYard)->Apply(pipelineCases);
+BENCHMARK(BM_EvaluatePostfix)->Apply(pipelineCases);
+BENCHMARK(BM_CompiledEvaluate)->Apply(pipelineCases);
+BENCHMARK(BM_CompiledFormula)->ArgName("optimize")->Arg(0)->Arg(1);
+BENCHMARK(BM_CompiledCall)->ArgName("call")->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_Calculate, CalculatorCore::Engine::ShuntingYard)->Apply(pipelineCases);
+BENCHMARK_TEMPLATE(BM_Calculate, CalculatorCore::Engine::Pratt)->Apply(pipelineCases);
+BENCHMARK_TEMPLATE(BM_CalculateMixedCorpus, CalculatorCore::Engine::ShuntingYard);
+BENCHMARK_TEMPLATE(BM_CalculateMixedCorpus, CalculatorCore::Engine::Pratt);
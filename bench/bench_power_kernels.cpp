@@ -0,0 +1,90 @@
+#include "calculator/power_kernels.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+constexpr size_t kBases = 1024;
+
+const std::vector<double>& bases() {
+    static const std::vector<double> values = [] {
+        std::mt19937_64 rng(3);
+        std::uniform_real_distribution<double> distribution(0.1, 10.0);
+        std::vector<double> out(kBases);
+        for (auto& value : out) {
+            value = distribution(rng);
+        }
+        return out;
+    }();
+    return values;
+}
+
+// Exponents are passed through range(0) as thousandths so that the compiler cannot specialize on them
+double exponentOf(const benchmark::State& state) { return static_cast<double>(state.range(0)) / 1000.0; }
+
+template <typename Kernel>
+void runKernel(benchmark::State& state, Kernel kernel) {
+    const auto& input = bases();
+    double exponent = exponentOf(state);
+    for (auto _ : state) {
+        for (double base : input) {
+            benchmark::DoNotOptimize(kernel(base, exponent));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+void BM_StdPow(benchmark::State& state) {
+    runKernel(state, [](double base, double exponent) { return std::pow(base, exponent); });
+}
+
+void BM_PowerFaithful(benchmark::State& state) {
+    runKernel(state, [](double base, double exponent) {
+        return power_kernels::pow(base, exponent, power_kernels::Accuracy::Faithful);
+    });
+}
+
+void BM_PowerFast(benchmark::State& state) {
+    runKernel(state, [](double base, double exponent) {
+        return power_kernels::pow(base, exponent, power_kernels::Accuracy::Fast);
+    });
+}
+
+// 2^n with integer n takes the exact ldexp path regardless of tier
+void BM_PowerOfTwo(benchmark::State& state) {
+    const auto& input = bases();
+    for (auto _ : state) {
+        for (double value : input) {
+            benchmark::DoNotOptimize(power_kernels::pow(2.0, std::floor(value)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+void BM_StdPowOfTwo(benchmark::State& state) {
+    const auto& input = bases();
+    for (auto _ : state) {
+        for (double value : input) {
+            benchmark::DoNotOptimize(std::pow(2.0, std::floor(value)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+void exponents(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgName("exponent_x1000");
+    // The kernel fast paths, an integer exponent for squaring, and a general exponent that falls back
+    for (int64_t exponent : {2000, 3000, 500, -1000, 7000, -5000, 2500}) {
+        benchmark->Arg(exponent);
+    }
+}
+} // namespace
+
+BENCHMARK(BM_StdPow)->Apply(exponents);
+BENCHMARK(BM_PowerFaithful)->Apply(exponents);
+BENCHMARK(BM_PowerFast)->Apply(exponents);
+BENCHMARK(BM_StdPowOfTwo);
+BENCHMARK(BM_PowerOfTwo);
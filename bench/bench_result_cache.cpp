@@ -0,0 +1,29 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/result_cache.hpp"
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+const std::string kExpression = "(12.5 + 3) * (7 - 2) / 4 ^ 2 - (1 + 2) * 3";
+
+void BM_CalculateUncached(benchmark::State& state) {
+    CalculatorCore calc;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.calculate(kExpression));
+    }
+}
+
+void BM_ResultCacheHit(benchmark::State& state) {
+    CalculatorCore calc;
+    ResultCache cache;
+    cache.calculate(calc, kExpression);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.calculate(calc, kExpression));
+    }
+}
+} // namespace
+
+BENCHMARK(BM_CalculateUncached);
+BENCHMARK(BM_ResultCacheHit)->ThreadRange(1, 8);
@@ -0,0 +1,30 @@
+#ifndef CALCULATOR_CORE_PEER_H
+#define CALCULATOR_CORE_PEER_H
+
+#include "calculator/calculator_core.hpp"
+
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Exposes CalculatorCore's private pipeline stages to benchmarks
+ */
+struct CalculatorCorePeer {
+    using Token = CalculatorCore::Token;
+
+    static CalcResult tokenize(const CalculatorCore& calc, std::string_view expression, std::vector<Token>& tokens) {
+        return calc.tokenize(expression, tokens);
+    }
+
+    static CalcResult shuntingYard(const CalculatorCore& calc, const std::vector<Token>& tokens,
+                                   std::vector<Token>& output, std::vector<Token>& ops) {
+        return calc.shuntingYard(tokens, output, ops);
+    }
+
+    static CalcResult evaluatePostfix(const CalculatorCore& calc, const std::vector<Token>& rpn,
+                                  std::vector<double>& values) {
+        return calc.evaluatePostfix(rpn, values);
+    }
+};
+
+#endif // CALCULATOR_CORE_PEER_H
@@ -0,0 +1,105 @@
+#include "corpus.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace corpus {
+namespace {
+char pickOperator(std::mt19937& rng, OperatorMix mix) {
+    static constexpr char kAdditive[] = {'+', '-'};
+    static constexpr char kMultiplicative[] = {'*', '/'};
+    static constexpr char kMixed[] = {'+', '-', '*', '/'};
+    static constexpr char kWithPower[] = {'+', '-', '*', '/', '^'};
+    switch (mix) {
+    case OperatorMix::Additive:
+        return kAdditive[rng() % 2];
+    case OperatorMix::Multiplicative:
+        return kMultiplicative[rng() % 2];
+    case OperatorMix::Mixed:
+        return kMixed[rng() % 4];
+    case OperatorMix::WithPower:
+        return kWithPower[rng() % 5];
+    }
+    return '+';
+}
+
+void appendNumber(std::string& out, std::mt19937& rng) {
+    // Non-zero operands keep random '/' from dividing by zero
+    out += std::to_string(1 + rng() % 99);
+    if (rng() % 4 == 0) {
+        out += '.';
+        out += std::to_string(rng() % 100);
+    }
+}
+
+void appendGroup(std::string& out, std::mt19937& rng, size_t terms, size_t depth, OperatorMix mix) {
+    for (size_t i = 0; i < terms;) {
+        if (i > 0) {
+            out += pickOperator(rng, mix);
+        }
+        if (depth > 0 && terms - i >= 2 && rng() % 3 == 0) {
+            size_t inner = 2 + rng() % std::min<size_t>(terms - i - 1, 4);
+            out += '(';
+            appendGroup(out, rng, inner, depth - 1, mix);
+            out += ')';
+            i += inner;
+        } else {
+            appendNumber(out, rng);
+            i++;
+        }
+    }
+}
+} // namespace
+
+std::string randomExpression(size_t terms, size_t maxDepth, OperatorMix mix, uint32_t seed) {
+    // Subtraction can still produce a zero divisor, so retry until the expression evaluates cleanly
+    CalculatorCore calc;
+    for (;; seed++) {
+        std::mt19937 rng(seed);
+        std::string out;
+        appendGroup(out, rng, terms, maxDepth, mix);
+        try {
+            calc.calculate(out);
+            return out;
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+std::string deepParentheses(size_t depth) {
+    std::string out;
+    out.reserve(depth * 4);
+    for (size_t i = 0; i < depth; i++) {
+        out += "1+(";
+    }
+    out += '1';
+    out.append(depth, ')');
+    return out;
+}
+
+std::string longChain(size_t tokens) {
+    static constexpr char kOps[] = {'+', '*', '-', '/'};
+    std::string out = "1";
+    for (size_t i = 1; i + 1 < tokens; i += 2) {
+        out += kOps[(i / 2) % 4];
+        out += std::to_string(1 + (i / 2) % 9);
+    }
+    return out;
+}
+
+std::vector<std::string> mixedCorpus(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        // Mostly short formulas with an occasional long one
+        size_t terms = rng() % 10 == 0 ? 20 + rng() % 40 : 2 + rng() % 6;
+        out.push_back(randomExpression(terms, 3, OperatorMix::WithPower, rng()));
+    }
+    return out;
+}
+
+} // namespace corpus
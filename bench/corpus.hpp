@@ -0,0 +1,42 @@
+#ifndef CALCULATOR_BENCH_CORPUS_H
+#define CALCULATOR_BENCH_CORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Deterministic expression generators for benchmarks
+ */
+namespace corpus {
+
+/**
+ * @brief Operator mixes used when generating binary operators
+ */
+enum class OperatorMix { Additive, Multiplicative, Mixed, WithPower };
+
+/**
+ * @brief Random expression with @p terms operands, wrapping groups in parentheses up to @p maxDepth deep
+ * @details The result always evaluates without error, so benchmarks never measure the throwing path
+ */
+std::string randomExpression(size_t terms, size_t maxDepth, OperatorMix mix, uint32_t seed = 1);
+
+/**
+ * @brief "((((1))))"-style nesting, @p depth levels deep, combining a number at each level
+ */
+std::string deepParentheses(size_t depth);
+
+/**
+ * @brief A flat chain of roughly @p tokens tokens, e.g. "1+2*3-4/5..."
+ */
+std::string longChain(size_t tokens);
+
+/**
+ * @brief A fixed mix of short, medium and long expressions resembling typical traffic
+ */
+std::vector<std::string> mixedCorpus(size_t count, uint32_t seed = 1);
+
+} // namespace corpus
+
+#endif // CALCULATOR_BENCH_CORPUS_H
@@ -0,0 +1,94 @@
+#ifndef ASYNC_EVALUATOR_H
+#define ASYNC_EVALUATOR_H
+
+#include "calculator/calc_result.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @class AsyncEvaluator
+ * @brief Evaluates expressions on a background thread so the submitting thread never blocks on a calculation
+ *
+ * One thread submits and polls; a worker thread owns the CalculatorCore. Requests and results each pass through
+ * a single-slot mailbox, an atomic pointer that the producer and consumer exchange, so handing data off in either
+ * direction is wait-free. Only the newest submission matters: a new one replaces any request the worker has not
+ * taken yet and raises the cancellation flag that the worker's CalculatorCore polls, so a long evaluation stops
+ * early. The worker sleeps on a condition variable when it has nothing to do.
+ */
+class AsyncEvaluator {
+public:
+    /**
+     * @param onResult Called on the worker thread after each result is published, e.g. to wake an event loop
+     */
+    explicit AsyncEvaluator(std::function<void()> onResult = {});
+    ~AsyncEvaluator();
+
+    // Delete copy/move operations since the worker holds a pointer back to the evaluator
+    AsyncEvaluator(const AsyncEvaluator&) = delete;
+    AsyncEvaluator(AsyncEvaluator&&) = delete;
+    AsyncEvaluator& operator=(const AsyncEvaluator&) = delete;
+    AsyncEvaluator& operator=(AsyncEvaluator&&) = delete;
+
+    /**
+     * @brief Start evaluating @p expression, cancelling any earlier submission
+     */
+    void submit(std::string expression);
+
+    /**
+     * @brief Cancel the current submission; its result, if it still arrives, is discarded
+     */
+    void cancel();
+
+    /**
+     * @brief Take the result of the latest submission if it is ready
+     * @return true if @p result was set; results of superseded submissions are dropped
+     */
+    bool poll(CalcResult& result);
+
+    /**
+     * @brief Whether the latest submission is still awaiting its result
+     */
+    bool busy() const { return m_received != m_submitted; }
+
+private:
+    struct Request {
+        uint64_t id;
+        std::string expression;
+    };
+
+    struct Response {
+        uint64_t id;
+        CalcResult result;
+    };
+
+    static_assert(std::atomic<Request*>::is_always_lock_free, "Mailboxes must be lock-free");
+
+    std::atomic<Request*> m_request{nullptr};
+    std::atomic<Response*> m_response{nullptr};
+    std::atomic<uint64_t> m_latest{0}; // Id of the newest submission; anything else is stale
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_stopping{false};
+
+    // Only for parking the idle worker; data never passes under this lock
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+
+    std::function<void()> m_onResult;
+
+    // Owned by the submitting thread
+    uint64_t m_submitted = 0;
+    uint64_t m_received = 0;
+
+    std::thread m_thread; // Declared last so the worker starts after every member it uses
+
+    void workerLoop();
+    void wakeWorker();
+};
+
+#endif // ASYNC_EVALUATOR_H
@@ -0,0 +1,72 @@
+#ifndef BATCH_CALCULATOR_H
+#define BATCH_CALCULATOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Outcome of evaluating one expression in a batch
+ */
+struct BatchResult {
+    double value = 0.0;
+    std::string error; // Empty on success, otherwise the exception message
+
+    bool ok() const { return error.empty(); }
+};
+
+/**
+ * @class BatchCalculator
+ * @brief Evaluates many independent expressions in parallel on a work-stealing thread pool
+ *
+ * Each worker owns a CalculatorCore, so its scratch buffers are reused across items without
+ * synchronization. Work is split into chunks that idle workers steal from busy ones.
+ */
+class BatchCalculator {
+public:
+    /**
+     * @param threads Number of worker threads; 0 uses std::thread::hardware_concurrency()
+     */
+    explicit BatchCalculator(size_t threads = 0);
+    ~BatchCalculator();
+
+    // Delete copy/move operations since workers hold a pointer back to the pool
+    BatchCalculator(const BatchCalculator&) = delete;
+    BatchCalculator(BatchCalculator&&) = delete;
+    BatchCalculator& operator=(const BatchCalculator&) = delete;
+    BatchCalculator& operator=(BatchCalculator&&) = delete;
+
+    /**
+     * @brief Evaluate every expression
+     * @param expressions The expressions to evaluate
+     * @return One result per expression, in input order
+     * @note Calls must not overlap; the pool runs one batch at a time
+     */
+    std::vector<BatchResult> calculate(const std::vector<std::string>& expressions);
+
+    size_t threadCount() const { return m_workers.size(); }
+
+private:
+    struct Worker;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation = 0;
+    size_t m_active = 0;
+    bool m_stopping = false;
+
+    const std::vector<std::string>* m_input = nullptr;
+    BatchResult* m_output = nullptr;
+
+    void workerLoop(size_t index);
+    bool takeChunk(size_t index, size_t& begin, size_t& end);
+};
+
+#endif // BATCH_CALCULATOR_H
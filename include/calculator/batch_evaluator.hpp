@@ -0,0 +1,56 @@
+#ifndef BATCH_EVALUATOR_H
+#define BATCH_EVALUATOR_H
+
+#include "calculator/compiled_expression.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class BatchEvaluator
+ * @brief Evaluates a CompiledExpression over structure-of-arrays input columns
+ *
+ * Rows are processed in fixed-size blocks; every RPN instruction runs over a whole block with
+ * vectorized kernels (AVX2 when compiled with CALCULATOR_ENABLE_AVX2, SSE2 on x86-64, scalar otherwise).
+ * A row that divides by zero is reported per row instead of aborting the batch.
+ */
+class BatchEvaluator {
+public:
+    /**
+     * @brief Number of rows evaluated per block
+     */
+    static constexpr size_t kBlockSize = 256;
+
+    /**
+     * @param expression The program to evaluate; copied, so it may be destroyed afterwards
+     */
+    explicit BatchEvaluator(CompiledExpression expression);
+
+    /**
+     * @brief Evaluate the expression for every row
+     * @param columns One pointer per variable slot (see CompiledExpression::variables), each holding @p rows values
+     * @param rows Number of rows
+     * @param results Output array of @p rows values; failed rows are set to NaN
+     * @param errors Optional output array of @p rows flags; 1 where the row hit a division by zero, 0 otherwise
+     * @return The number of rows that failed
+     */
+    size_t evaluate(const double* const* columns, size_t rows, double* results, unsigned char* errors = nullptr);
+
+    /**
+     * @brief Convenience overload over equally sized column vectors
+     * @throws std::runtime_error if a column is missing or the columns differ in length
+     */
+    std::vector<double> evaluate(const std::vector<std::vector<double>>& columns,
+                                 std::vector<unsigned char>* errors = nullptr);
+
+    const CompiledExpression& expression() const { return m_expression; }
+
+private:
+    CompiledExpression m_expression;
+    std::vector<double> m_stack;     // maxStackDepth blocks of kBlockSize values
+    std::vector<double> m_errorMask; // One block; non-zero bits mark rows that divided by zero
+
+    void evaluateBlock(const double* const* columns, size_t offset, size_t count);
+};
+
+#endif // BATCH_EVALUATOR_H
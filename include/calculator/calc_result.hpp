@@ -0,0 +1,54 @@
+#ifndef CALC_RESULT_H
+#define CALC_RESULT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Reason an expression could not be evaluated
+ */
+enum class CalcError : uint8_t {
+    None,
+    EmptyExpression,
+    InvalidCharacter,
+    InvalidNumber,
+    MismatchedParentheses,
+    NotEnoughOperands,
+    TooManyOperands,
+    DivisionByZero,
+    UnboundVariable,
+    UnknownOperator,
+    Cancelled,
+    UnknownFunction,
+    WrongArgumentCount,
+    Count
+};
+
+/**
+ * @brief Non-throwing outcome of an evaluation: a value, or an error code and where it happened
+ */
+struct CalcResult {
+    double value = 0.0;
+    CalcError error = CalcError::None;
+    uint32_t position = 0; // Character offset of the failure in the input expression
+
+    bool ok() const { return error == CalcError::None; }
+
+    static CalcResult success(double value) { return {value, CalcError::None, 0}; }
+    static CalcResult failure(CalcError error, uint32_t position) { return {0.0, error, position}; }
+};
+
+/**
+ * @brief Static, human-readable description of an error code
+ */
+const char* errorName(CalcError error);
+
+/**
+ * @brief Full error message for a failed result, e.g. "Invalid character in expression: $"
+ * @param result A failed result
+ * @param expression The expression that produced @p result, used to quote the offending text
+ */
+std::string formatError(const CalcResult& result, std::string_view expression);
+
+#endif // CALC_RESULT_H
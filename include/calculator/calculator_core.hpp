@@ -1,8 +1,15 @@
 #ifndef CALCULATOR_CORE_H
 #define CALCULATOR_CORE_H
 
+#include "calculator/calc_result.hpp"
+#include "calculator/compiled_expression.hpp"
+#include "calculator/function_table.hpp"
+
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -11,6 +18,20 @@
  */
 class CalculatorCore {
 public:
+    /**
+     * @brief Evaluation strategy used by calculate() and tryCalculate()
+     * @details Both engines return identical values, error codes and error positions.
+     */
+    enum class Engine : unsigned char {
+        ShuntingYard, // tokenize, convert to RPN, then evaluate, through reusable scratch buffers
+        Pratt         // single pass that lexes, parses and evaluates with memory bounded by nesting depth
+    };
+
+    /**
+     * @brief Default cap on retained scratch memory, in bytes
+     */
+    static constexpr size_t kDefaultScratchLimit = size_t{1} << 20;
+
     CalculatorCore();
     ~CalculatorCore();
 
@@ -26,57 +47,184 @@ public:
      * @return The result of the calculation
      * @throws std::runtime_error if the expression is invalid
      */
-    double calculate(const std::string& expression);
+    double calculate(std::string_view expression);
+
+    /**
+     * @brief Perform a calculation without throwing
+     * @param expression The mathematical expression to evaluate
+     * @return The value, or an error code and the character offset where evaluation failed;
+     *         use formatError for a message
+     */
+    CalcResult tryCalculate(std::string_view expression);
+
+    /**
+     * @brief Parse an expression once into a program that can be evaluated many times
+     * @param expression The mathematical expression to compile; identifiers not called as functions become variables
+     * @param options Optimizations to apply; see CompiledExpression::opsSaved for their effect
+     * @return The compiled program
+     * @throws std::runtime_error if the expression is invalid
+     */
+    CompiledExpression compile(std::string_view expression, const CompileOptions& options = {}) const;
+
+    /**
+     * @brief Make @p name callable in expressions as name(a, b, ...) with exactly @p arity arguments
+     * @details Calls are resolved when an expression is parsed or compiled, so programs compiled earlier are
+     *          unaffected. A ResultCache keys on the expression text alone; share one only between calculators
+     *          that define the same functions.
+     * @param function Must be pure, since calls with constant arguments are folded at compile time
+     * @throws std::runtime_error if @p name is not an identifier or is already defined, including as a
+     *         built-in, or @p arity is 0 or above FunctionTable::kMaxArity
+     */
+    void registerFunction(std::string_view name, size_t arity, FunctionTable::Callback function) {
+        m_functions.add(name, arity, function);
+    }
 
-    // Memory operations
-    // void storeInMemory(double value);
-    // double recallMemory() const;
-    // void clearMemory();
+    /**
+     * @brief The built-in and registered functions
+     */
+    const FunctionTable& functions() const { return m_functions; }
+
+    /**
+     * @brief Select the engine for subsequent calculations
+     */
+    void setEngine(Engine engine) { m_engine = engine; }
+
+    /**
+     * @brief The engine currently used for calculations
+     */
+    Engine engine() const { return m_engine; }
+
+    /**
+     * @brief Cap the scratch memory kept between calculations
+     * @details Scratch buffers grow to fit the largest expression seen and are reused, so steady-state
+     *          calculation does not allocate. A call that leaves more than @p bytes reserved releases it
+     *          all, so a single huge expression cannot pin memory in a long-lived instance.
+     */
+    void setScratchLimit(size_t bytes) { m_scratchLimit = bytes; }
+
+    size_t scratchLimit() const { return m_scratchLimit; }
+
+    /**
+     * @brief Bytes currently reserved by the scratch buffers
+     */
+    size_t scratchBytes() const;
+
+    /**
+     * @brief Tokens processed between polls of the cancellation flag
+     */
+    static constexpr size_t kCancelCheckInterval = 1024;
+
+    /**
+     * @brief Let another thread stop calculations early
+     * @details Every kCancelCheckInterval tokens, each stage checks @p flag and fails with CalcError::Cancelled
+     *          once it is set. The flag must outlive its use; nullptr, the default, disables the checks.
+     */
+    void setCancellationFlag(const std::atomic<bool>* flag) { m_cancelFlag = flag; }
+
+    /**
+     * @brief Memory register (M+/MR/MC); HistoryLog persists it across sessions
+     */
+    void storeInMemory(double value) { m_memory = value; }
+    double recallMemory() const { return m_memory; }
+    void clearMemory() { m_memory = 0.0; }
 
 private:
-    // double memory = 0.0;  // For future memory feature
+    friend class BatchEvaluator;
+    friend class CompiledExpression;
+    friend class ExpressionOptimizer;
+    friend class IncrementalEvaluator;
+    friend class PrattParser;
+    friend struct CalculatorCorePeer; // Test and benchmark access to the individual pipeline stages
 
+    /**
+     * @brief Trivially copyable token; numbers are parsed once and function names resolved during tokenization
+     */
     struct Token {
-        enum Type { Number, Operator, Parenthesis };
+        enum Type : unsigned char { Number, Variable, Function, Operator, UnaryOperator, Parenthesis, Separator };
         Type type;
-        std::string value;
+        char symbol = 0;        // Operator, parenthesis or separator character
+        uint16_t function = 0;  // Id of a Function; on the operator stack, a '(' also counts its call's separators
+        uint32_t position = 0;  // Offset of the token in the tokenized expression
+        double number = 0.0;    // Value of a Number token
+        std::string_view name{}; // Variable name, a view into the tokenized expression
     };
 
+    Engine m_engine = Engine::ShuntingYard;
+    size_t m_scratchLimit = kDefaultScratchLimit;
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+    double m_memory = 0.0;
+    FunctionTable m_functions;
+
+    // Scratch buffers reused across calculate() calls so steady-state evaluation does not allocate
+    std::vector<Token> m_tokens;
+    std::vector<Token> m_rpn;
+    std::vector<Token> m_operators;
+    std::vector<double> m_values;
+
+    /**
+     * @brief Free the scratch buffers; the next calculation reallocates what it needs
+     */
+    void releaseScratch();
+
+    /**
+     * @brief Whether @p flag is set, checked only when @p count is a multiple of kCancelCheckInterval
+     */
+    static bool cancelRequested(const std::atomic<bool>* flag, size_t count) {
+        return flag && count % kCancelCheckInterval == 0 && flag->load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Checks if a character is an operator
      * @return true if the character is an operator, false otherwise
      */
     static bool isOperator(char c);
 
+    /**
+     * @brief Checks if a character can start an identifier
+     * @return true for letters and underscore, false otherwise
+     */
+    static bool isIdentifierStart(char c);
+
     /**
      * @brief Converts expression string into tokens
-     * @throws std::runtime_error for invalid characters
+     * @details A '-' in operand position becomes the unary negation operator '~'; a unary '+' is dropped
+     * @details An identifier immediately followed by '(' is a function call and becomes a Function token
+     * @param tokens Output buffer, cleared first; Variable tokens view into @p expression
+     * @return An error for invalid characters, malformed numbers, unknown functions or misplaced operands/operators
      */
-    std::vector<Token> tokenize(const std::string& expression) const;
+    CalcResult tokenize(std::string_view expression, std::vector<Token>& tokens) const;
 
     /**
      * @brief Converts infix tokens to postfix notation (RPN)
-     * @throws std::runtime_error for mismatched parentheses
+     * @param output Output buffer, cleared first
+     * @param ops Scratch operator stack
+     * @return An error for mismatched parentheses or a call with the wrong number of arguments
      */
-    std::vector<Token> shuntingYard(const std::vector<Token>& tokens) const;
+    CalcResult shuntingYard(const std::vector<Token>& tokens, std::vector<Token>& output, std::vector<Token>& ops) const;
 
     /**
      * @brief Evaluates postfix (RPN) expression
-     * @throws std::runtime_error for invalid operations
+     * @param values Scratch value stack
+     * @return The value, or an error for invalid operations
      */
-    double evaluatePostfix(const std::vector<Token>& rpn) const;
+    CalcResult evaluatePostfix(const std::vector<Token>& rpn, std::vector<double>& values) const;
 
     /**
      * @brief Gets operator precedence
      * @return int Precedence level (higher = earlier evaluation)
      */
-    int getPrecedence(char op) const;
+    static int getPrecedence(char op);
+
+    /**
+     * @brief Whether a binary operator groups right to left, so that 2^3^2 == 2^(3^2)
+     */
+    static bool isRightAssociative(char op);
 
     /**
      * @brief Applies a binary operation
-     * @throws std::runtime_error for division by zero or unknown operators
+     * @return The value, or an error (without a position) for division by zero or unknown operators
      */
-    double applyOperation(char op, double a, double b) const;
+    static CalcResult applyOperation(char op, double a, double b);
 };
 
 #endif // CALCULATOR_CORE_H
@@ -1,12 +1,20 @@
 #ifndef CALCULATOR_GUI_H
 #define CALCULATOR_GUI_H
 
+#include "calculator/async_evaluator.hpp"
 #include "calculator/calculator_core.hpp"
+#include "calculator/function_sampler.hpp"
+#include "calculator/history_log.hpp"
+#include "calculator/incremental_evaluator.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 struct GLFWwindow;
+struct ImVec2;
 
 /**
  * @class CalculatorGUI
@@ -34,21 +42,109 @@ public:
      */
     void run();
 
+    /**
+     * @brief Schedule frames to be drawn; the loop otherwise sleeps until input arrives
+     */
+    void requestRedraw();
+
+    /**
+     * @brief Show or hide the frame-time overlay, which F12 also toggles
+     */
+    void setFrameStatsVisible(bool visible);
+
 private:
+    /**
+     * @brief Loop timing, summarized once per sampling window for the overlay
+     */
+    struct FrameStats {
+        uint64_t redraws = 0;           // Frames drawn since start
+        double frameMilliseconds = 0.0; // Mean time to build and submit a frame, over the last window
+        double idlePercent = 0.0;       // Share of the last window spent blocked waiting for events
+        double windowStart = 0.0;
+        double windowIdle = 0.0;
+        double windowBusy = 0.0;
+        uint32_t windowFrames = 0;
+    };
+
+    /**
+     * @brief Visible region of the plot, in expression units
+     */
+    struct PlotView {
+        double xMin = -10.0;
+        double xMax = 10.0;
+        double yMin = -10.0;
+        double yMax = 10.0;
+    };
+
+    // ImGui sees input one frame late and settles hover/active state on the next, so each event gets a few frames
+    static constexpr int kFramesPerEvent = 3;
+
+
     GLFWwindow* m_window = nullptr;
-    std::unique_ptr<CalculatorCore> m_calculator_core;
+    std::unique_ptr<CalculatorCore> m_calculator_core; // Compiles plots and holds the memory register
+    std::unique_ptr<AsyncEvaluator> m_evaluator;       // Evaluates off the render thread so frames never wait on '='
+    std::unique_ptr<HistoryLog> m_history;             // Null when the log cannot be opened
+    std::string m_pendingExpression;                   // Submitted to m_evaluator, logged with its result
     double m_result = 0.0;
     std::string m_displayBuffer = "0";
+    IncrementalEvaluator m_preview; // Mirrors m_displayBuffer keystroke by keystroke
+    int m_pendingFrames = kFramesPerEvent;
+    bool m_showFrameStats = false;
+    FrameStats m_frameStats;
+
+    bool m_historyVisible = false;
+    bool m_plotVisible = false;
+    PlotView m_plotView;
+    std::string m_plotExpression; // The buffer m_sampler was compiled from
+    std::string m_plotError;      // Why m_plotExpression cannot be plotted, if it cannot
+    std::unique_ptr<FunctionSampler> m_sampler;
+    std::vector<FunctionSampler::Point> m_plotPoints; // Reused every frame
+    std::vector<ImVec2> m_plotLine;
 
     /**
      * @brief Render the GUI
      */
     void render();
 
+    /**
+     * @brief Show the result of the last '=' once the worker delivers it
+     */
+    void pollEvaluation();
+
+    /**
+     * @brief Render the live result of the expression being typed
+     */
+    void renderPreview();
+
+    /**
+     * @brief Render the history list, newest first; clicking an entry loads its expression
+     */
+    void renderHistory();
+
+    /**
+     * @brief Render the plot of the buffer as a function of x; drag to pan, scroll to zoom
+     */
+    void renderPlot();
+
+    /**
+     * @brief Render the frame-time overlay
+     */
+    void renderFrameStats();
+
+    /**
+     * @brief Account a drawn frame that took @p busySeconds
+     */
+    void recordFrame(double busySeconds);
+
+    /**
+     * @brief Set the memory register and persist it
+     */
+    void storeMemory(double value);
+
     /**
      * @brief Process the button click
      */
-    void processButtonClick(const std::string& label);
+    void processButtonClick(std::string_view label);
 };
 
 #endif // CALCULATOR_GUI_H
@@ -0,0 +1,82 @@
+#ifndef CALCULATOR_STATS_H
+#define CALCULATOR_STATS_H
+
+#include "calculator/calc_result.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Opt-in hot-path instrumentation for CalculatorCore
+ *
+ * Counters are only collected when the library is built with CALCULATOR_ENABLE_STATS; otherwise the
+ * recording hooks compile to nothing and snapshot() returns zeros. Each thread writes to its own
+ * counter block, so instrumentation adds no shared-cache-line traffic under parallel use.
+ */
+namespace calculator_stats {
+
+/**
+ * @brief Whether instrumentation was compiled in
+ */
+#if defined(CALCULATOR_ENABLE_STATS) && CALCULATOR_ENABLE_STATS
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+/**
+ * @brief Timed stages; Pratt covers the whole single-pass engine, which has no separate stages
+ */
+enum class Stage : uint8_t { Tokenize, ShuntingYard, Evaluate, Pratt, Count };
+
+/**
+ * @brief Errors are counted by the same codes tryCalculate reports
+ */
+using ErrorKind = CalcError;
+
+/**
+ * @brief Latency histogram with power-of-two nanosecond buckets
+ * @details Bucket i counts samples in [2^(i-1), 2^i) ns; bucket 0 counts samples under 1 ns.
+ */
+struct Histogram {
+    static constexpr size_t kBuckets = 40;
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t count = 0;
+    uint64_t totalNanoseconds = 0;
+
+    /**
+     * @brief Upper bound of the bucket containing the requested percentile, in nanoseconds
+     * @param percentile Value in [0, 100]
+     */
+    uint64_t percentileNanoseconds(double percentile) const;
+};
+
+/**
+ * @brief Totals across every thread that has used a CalculatorCore
+ */
+struct Snapshot {
+    std::array<Histogram, static_cast<size_t>(Stage::Count)> stages{};
+    std::array<uint64_t, static_cast<size_t>(ErrorKind::Count)> errors{};
+    uint64_t calculations = 0;
+    uint64_t tokens = 0;
+    uint64_t maxOperatorStackDepth = 0;
+
+    const Histogram& stage(Stage s) const { return stages[static_cast<size_t>(s)]; }
+    uint64_t errorCount(ErrorKind kind) const { return errors[static_cast<size_t>(kind)]; }
+};
+
+/**
+ * @brief Sum the counters of all live and exited threads
+ */
+Snapshot snapshot();
+
+/**
+ * @brief Zero every counter
+ */
+void reset();
+
+} // namespace calculator_stats
+
+#endif // CALCULATOR_STATS_H
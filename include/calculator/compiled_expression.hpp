@@ -0,0 +1,182 @@
+#ifndef COMPILED_EXPRESSION_H
+#define COMPILED_EXPRESSION_H
+
+#include "calculator/calc_result.hpp"
+#include "calculator/function_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Optimizations applied by CalculatorCore::compile
+ */
+struct CompileOptions {
+    /**
+     * @brief Fold constant subexpressions and apply identities that preserve results: x*1, x+0, x-0, x/1, x^1,
+     *        --x and x^2 -> x*x. The only observable difference is that x+0 keeps the sign of a zero x.
+     */
+    bool optimize = true;
+
+    /**
+     * @brief Also rewrite division by a non-zero constant as multiplication by its reciprocal, which can
+     *        change the last bit of the result
+     */
+    bool fastMath = false;
+};
+
+/**
+ * @class CompiledExpression
+ * @brief Pre-parsed bytecode program that can be evaluated repeatedly without re-tokenizing
+ *
+ * Created by CalculatorCore::compile. Variables are numbered in order of first appearance
+ * and are bound at evaluation time; function calls are resolved to callbacks at compile time,
+ * so the program does not depend on the calculator that compiled it. The built-ins min, max, abs
+ * and sqrt compile to opcodes of their own and cost what an operator does; other calls go through
+ * the callback with an argument array. The program is a stack
+ * machine over fixed-width 32-bit instructions; the interpreter uses direct-threaded dispatch
+ * where the compiler supports computed goto and a switch loop otherwise.
+ */
+class CompiledExpression {
+public:
+    CompiledExpression() = default;
+
+    /**
+     * @brief Evaluate the program with positional variable bindings
+     * @param values Variable values, indexed in the order of variables()
+     * @return The result of the calculation
+     * @throws std::runtime_error if a variable is unbound or an operation fails
+     */
+    double evaluate(const std::vector<double>& values = {}) const;
+
+    /**
+     * @brief Evaluate the program without throwing
+     * @param values Variable values, indexed in the order of variables()
+     * @return The value, or an error code with the offset of the failing token in the compiled expression
+     */
+    CalcResult tryEvaluate(const std::vector<double>& values) const;
+
+    /**
+     * @brief Evaluate the program with positional variable bindings, e.g. evaluate({1.0, 2.0})
+     */
+    double evaluate(std::initializer_list<double> values) const { return evaluate(std::vector<double>(values)); }
+
+    /**
+     * @brief Evaluate the program with named variable bindings
+     * @param bindings Variable values keyed by name; extra names are ignored
+     * @return The result of the calculation
+     * @throws std::runtime_error if a variable is unbound or an operation fails
+     */
+    double evaluate(const std::unordered_map<std::string, double>& bindings) const;
+
+    /**
+     * @brief Names of the variables referenced by the expression, in slot order
+     */
+    const std::vector<std::string>& variables() const { return m_variables; }
+
+    /**
+     * @brief Looks up the slot of a variable
+     * @return The slot index, or std::nullopt if the expression does not reference the name
+     */
+    std::optional<size_t> variableIndex(std::string_view name) const;
+
+    /**
+     * @brief Number of instructions the optimizer removed from the program
+     */
+    size_t opsSaved() const { return m_opsSaved; }
+
+private:
+    friend class BatchEvaluator;
+    friend class CalculatorCore;
+    friend class ExpressionOptimizer;
+
+    /**
+     * @brief Instruction opcodes; the order is mirrored by the interpreter's dispatch table
+     */
+    enum class Opcode : uint8_t {
+        Constant,
+        Variable,
+        Dup,
+        Negate,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Power,
+        Min,
+        Max,
+        Abs,
+        Sqrt,
+        Call,
+        Return
+    };
+
+    /**
+     * @brief Callee of a Call instruction
+     */
+    struct Function {
+        FunctionTable::Callback call;
+        uint32_t arity;
+    };
+
+    /**
+     * @brief Operands (constant index, variable slot or callee index) live in the upper 24 bits of an
+     *        instruction word
+     */
+    static constexpr uint32_t kOperandShift = 8;
+    static constexpr uint32_t kMaxOperand = (1u << (32 - kOperandShift)) - 1;
+
+    /**
+     * @brief Programs whose stack fits in this many values evaluate without allocating
+     */
+    static constexpr size_t kLocalStackSize = 64;
+
+    static constexpr uint32_t encode(Opcode opcode, uint32_t operand = 0) {
+        return static_cast<uint32_t>(opcode) | (operand << kOperandShift);
+    }
+    static constexpr Opcode opcodeOf(uint32_t instruction) { return static_cast<Opcode>(instruction & 0xff); }
+    static constexpr uint32_t operandOf(uint32_t instruction) { return instruction >> kOperandShift; }
+
+    /**
+     * @brief Opcode for a binary operator character ('+', '-', '*', '/', '^')
+     */
+    static Opcode binaryOpcode(char op);
+
+    /**
+     * @brief Dedicated opcode of a built-in function (Min, Max, Abs or Sqrt), or std::nullopt to emit a Call
+     * @details Built-in names cannot be registered again, so the name identifies the function.
+     */
+    static std::optional<Opcode> intrinsicOpcode(std::string_view function);
+
+    /**
+     * @brief The built-in function a dedicated opcode evaluates, for folding and per-lane evaluation
+     */
+    static Function intrinsicFunction(Opcode opcode);
+
+    std::vector<uint32_t> m_code;       // Always terminated by Return
+    std::vector<double> m_constants;    // Constant pool, indexed by the operand of Constant instructions
+    std::vector<uint32_t> m_positions;  // Source offset of each instruction, read only to report errors
+    std::vector<std::string> m_variables;
+    std::vector<Function> m_functions;  // Callees, indexed by the operand of Call instructions
+    size_t m_maxStackDepth = 0;
+    size_t m_opsSaved = 0;
+
+    /**
+     * @brief Append Return and compute m_maxStackDepth once the instructions are final
+     */
+    void finalize();
+
+    /**
+     * @brief Run the program
+     * @param variables At least variables().size() values
+     * @param stack Room for m_maxStackDepth values
+     */
+    CalcResult execute(const double* variables, double* stack) const;
+};
+
+#endif // COMPILED_EXPRESSION_H
@@ -0,0 +1,494 @@
+#ifndef CALCULATOR_CONSTEXPR_EXPRESSION_H
+#define CALCULATOR_CONSTEXPR_EXPRESSION_H
+
+#include "calculator/calc_result.hpp"
+#include "calculator/operator_precedence.hpp"
+#include "calculator/power_kernels.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Compile-time counterpart of CalculatorCore for expressions written as string literals
+ *
+ * Accepts the same operators with the same precedence table (operator_precedence.hpp), but not function
+ * calls: sqrt(x), max(a, b) and registered functions are not supported at compile time.
+ * @code
+ * constexpr double area = CALCULATOR_CONSTANT("3.5 * 2^2");   // folded by the compiler
+ * static const auto kinetic = CALCULATOR_FORMULA("0.5 * m * v^2");
+ * double energy = kinetic.evaluate(2.0, 3.0);                   // variables bind in order of first use
+ * @endcode
+ * A malformed literal, a call, or a constant division by zero is a compile error. Formulas with variables
+ * compile to straight-line code: the program and every stack slot are known at compile time.
+ *
+ * Constant folding matches runtime evaluation bit for bit. Powers are folded only where power_kernels
+ * computes them exactly (exponents 0, 1, 2, 3, -1 and powers of two); other powers are evaluated at
+ * runtime. An operation whose result would overflow to infinity (such as 0^-1 or 2^1023 * 2^1023) is also
+ * left to runtime, where it yields inf as CalculatorCore does, so CALCULATOR_CONSTANT rejects it as not a
+ * compile-time constant. A number literal is parsed exactly when its digits form an integer below 2^53 with
+ * at most 22 of them after the point; longer literals may differ from the runtime parser by an ULP.
+ */
+namespace calculator_constexpr {
+
+enum class Op : uint8_t { Constant, Variable, Negate, Add, Subtract, Multiply, Divide, Power };
+
+struct Instruction {
+    Op op = Op::Constant;
+    double value = 0.0;    // Constant value
+    size_t slot = 0;       // Variable slot
+    size_t depth = 0;      // Stack size before the instruction executes
+    uint32_t position = 0; // Offset in the literal, for Divide errors
+};
+
+/**
+ * @brief RPN program parsed from a literal of N characters, which bounds the instruction count
+ */
+template <size_t N>
+struct Program {
+    std::array<Instruction, N> code{};
+    size_t size = 0;
+    std::array<std::string_view, N> variables{};
+    size_t variableCount = 0;
+    size_t maxDepth = 0;
+
+    constexpr bool isConstant() const { return size == 1 && code[0].op == Op::Constant; }
+};
+
+namespace detail {
+
+constexpr bool isDigit(char c) { return c >= '0' && c <= '9'; }
+constexpr bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+constexpr bool isIdentifierStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+constexpr bool isOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '/' || c == '^'; }
+
+/**
+ * @brief Whether power_kernels::pow gives the same result as folding with plain arithmetic
+ */
+constexpr bool isFoldablePower(double base, double exponent) {
+    if (exponent == 0.0 || exponent == 1.0 || exponent == 2.0 || exponent == 3.0 || exponent == -1.0) {
+        return true;
+    }
+    return base == 2.0 && exponent >= -1022.0 && exponent <= 1023.0 && static_cast<int>(exponent) == exponent;
+}
+
+constexpr double foldPower(double base, double exponent) {
+    if (exponent == 0.0) {
+        return 1.0;
+    }
+    if (exponent == 1.0) {
+        return base;
+    }
+    if (exponent == 2.0) {
+        return base * base;
+    }
+    if (exponent == 3.0) {
+        return base * base * base;
+    }
+    if (exponent == -1.0) {
+        return 1.0 / base;
+    }
+    // Integer power of two in the normal range: every step is exact
+    double result = 1.0;
+    for (int i = 0; i < static_cast<int>(exponent); i++) {
+        result *= 2.0;
+    }
+    for (int i = 0; i > static_cast<int>(exponent); i--) {
+        result /= 2.0;
+    }
+    return result;
+}
+
+constexpr double magnitude(double x) { return x < 0 ? -x : x; }
+
+/**
+ * @brief Whether a constant @p a op @p b is certainly finite, so folding it cannot overflow
+ * @details Overflow is not a constant expression. Near the limit this errs towards false, which only leaves
+ *          the operation to runtime. For '/', @p b is nonzero; for '^', isFoldablePower holds.
+ */
+constexpr bool staysFinite(char op, double a, double b) {
+    constexpr double kHalfMax = std::numeric_limits<double>::max() / 2;
+    double x = magnitude(a);
+    double y = magnitude(b);
+    switch (op) {
+    case '+':
+    case '-':
+        return x <= kHalfMax && y <= kHalfMax;
+    case '*':
+        return y <= 1.0 || x <= kHalfMax / y;
+    case '/':
+        return y >= 1.0 || x <= kHalfMax * y;
+    default:
+        if (b == -1.0) {
+            return a != 0.0 && staysFinite('/', 1.0, a);
+        }
+        if (b == 2.0 || b == 3.0) {
+            return staysFinite('*', a, a) && (b == 2.0 || staysFinite('*', a * a, a));
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Recursive-descent (precedence climbing) parser that emits RPN and folds constants as it goes
+ */
+template <size_t N>
+class Parser {
+public:
+    constexpr explicit Parser(std::string_view text) : m_text(text) {}
+
+    constexpr Program<N> parse() {
+        skipSpace();
+        if (m_pos >= m_text.size()) {
+            throw std::invalid_argument("Empty expression");
+        }
+        parseExpression(0);
+        skipSpace();
+        if (m_pos < m_text.size()) {
+            throw std::invalid_argument(m_text[m_pos] == ')' ? "Mismatched parentheses" : "Invalid expression: too many operands");
+        }
+        return m_program;
+    }
+
+private:
+    // One stack value and where its instructions start, as in ExpressionOptimizer
+    struct Fragment {
+        size_t begin = 0;
+        bool constant = false;
+        double value = 0.0;
+    };
+
+    std::string_view m_text;
+    size_t m_pos = 0;
+    size_t m_depth = 0;
+    Program<N> m_program{};
+
+    constexpr void skipSpace() {
+        while (m_pos < m_text.size() && isSpace(m_text[m_pos])) {
+            m_pos++;
+        }
+    }
+
+    constexpr void emit(Op op, double value, size_t slot, size_t position) {
+        Instruction instruction{};
+        instruction.op = op;
+        instruction.value = value;
+        instruction.slot = slot;
+        instruction.depth = m_depth;
+        instruction.position = static_cast<uint32_t>(position);
+        m_program.code[m_program.size++] = instruction;
+
+        if (op == Op::Constant || op == Op::Variable) {
+            m_depth++;
+        } else if (op != Op::Negate) {
+            m_depth--;
+        }
+        if (m_depth > m_program.maxDepth) {
+            m_program.maxDepth = m_depth;
+        }
+    }
+
+    // Replace the two constant instructions on top of the program with their folded value
+    constexpr Fragment fold(const Fragment& left, double value, size_t position) {
+        m_program.size = left.begin;
+        m_depth -= 2;
+        emit(Op::Constant, value, 0, position);
+        return {left.begin, true, value};
+    }
+
+    constexpr Fragment parseExpression(int minPrecedence) {
+        Fragment left = parsePrefix();
+        while (true) {
+            skipSpace();
+            if (m_pos >= m_text.size() || m_text[m_pos] == ')') {
+                return left;
+            }
+            char op = m_text[m_pos];
+            if (!isOperator(op)) {
+                if (isDigit(op) || op == '.' || op == '(' || isIdentifierStart(op)) {
+                    throw std::invalid_argument("Invalid expression: too many operands");
+                }
+                throw std::invalid_argument("Invalid character in expression");
+            }
+            int precedence = operatorPrecedence(op);
+            if (precedence < minPrecedence) {
+                return left;
+            }
+            size_t position = m_pos++;
+            Fragment right = parseExpression(operatorIsRightAssociative(op) ? precedence : precedence + 1);
+            left = applyBinary(op, left, right, position);
+        }
+    }
+
+    constexpr Fragment applyBinary(char op, const Fragment& left, const Fragment& right, size_t position) {
+        if (left.constant && right.constant) {
+            double a = left.value;
+            double b = right.value;
+            if (op == '/' && b == 0) {
+                throw std::domain_error("Division by zero");
+            }
+            if (staysFinite(op, a, b)) {
+                switch (op) {
+                case '+':
+                    return fold(left, a + b, position);
+                case '-':
+                    return fold(left, a - b, position);
+                case '*':
+                    return fold(left, a * b, position);
+                case '/':
+                    return fold(left, a / b, position);
+                default:
+                    if (isFoldablePower(a, b)) {
+                        return fold(left, foldPower(a, b), position);
+                    }
+                    break;
+                }
+            }
+        }
+
+        Op code = op == '+' ? Op::Add : op == '-' ? Op::Subtract : op == '*' ? Op::Multiply : op == '/' ? Op::Divide : Op::Power;
+        emit(code, 0.0, 0, position);
+        return {left.begin, false, 0.0};
+    }
+
+    constexpr Fragment parsePrefix() {
+        while (true) {
+            skipSpace();
+            if (m_pos >= m_text.size()) {
+                throw std::invalid_argument("Invalid expression: not enough operands");
+            }
+            size_t start = m_pos;
+            char c = m_text[m_pos];
+
+            if (isDigit(c) || c == '.') {
+                double value = parseNumber();
+                size_t begin = m_program.size;
+                emit(Op::Constant, value, 0, start);
+                return {begin, true, value};
+            }
+            if (isIdentifierStart(c)) {
+                while (m_pos < m_text.size() && (isIdentifierStart(m_text[m_pos]) || isDigit(m_text[m_pos]))) {
+                    m_pos++;
+                }
+                if (m_pos < m_text.size() && m_text[m_pos] == '(') {
+                    throw std::invalid_argument("Function calls are not supported at compile time");
+                }
+                size_t begin = m_program.size;
+                emit(Op::Variable, 0.0, slotOf(m_text.substr(start, m_pos - start)), start);
+                return {begin, false, 0.0};
+            }
+            if (c == '(') {
+                m_pos++;
+                Fragment inner = parseExpression(0);
+                skipSpace();
+                if (m_pos >= m_text.size()) {
+                    throw std::invalid_argument("Mismatched parentheses");
+                }
+                m_pos++;
+                return inner;
+            }
+            if (c == '-') {
+                m_pos++;
+                Fragment operand = parseExpression(operatorPrecedence('~') + 1);
+                if (operand.constant) {
+                    m_program.code[m_program.size - 1].value = -operand.value;
+                    return {operand.begin, true, -operand.value};
+                }
+                emit(Op::Negate, 0.0, 0, start);
+                return operand;
+            }
+            if (c == '+') {
+                m_pos++;
+                continue;
+            }
+            if (c == ')' || isOperator(c)) {
+                throw std::invalid_argument("Invalid expression: not enough operands");
+            }
+            throw std::invalid_argument("Invalid character in expression");
+        }
+    }
+
+    constexpr double parseNumber() {
+        uint64_t mantissa = 0;
+        int fractionDigits = 0;
+        int droppedDigits = 0; // Integer digits beyond what the mantissa can hold
+        bool seenPoint = false;
+        bool seenDigit = false;
+        while (m_pos < m_text.size() && (isDigit(m_text[m_pos]) || m_text[m_pos] == '.')) {
+            char c = m_text[m_pos++];
+            if (c == '.') {
+                if (seenPoint) {
+                    throw std::invalid_argument("Invalid number");
+                }
+                seenPoint = true;
+                continue;
+            }
+            seenDigit = true;
+            if (mantissa < (uint64_t{1} << 59)) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+                fractionDigits += seenPoint;
+            } else if (!seenPoint) {
+                droppedDigits++;
+            }
+        }
+        if (!seenDigit) {
+            throw std::invalid_argument("Invalid number");
+        }
+
+        // Both operands are exact when mantissa < 2^53 and 10^fractionDigits <= 10^22, so the
+        // quotient is correctly rounded, as std::from_chars would produce
+        double scale = 1.0;
+        for (int i = 0; i < fractionDigits; i++) {
+            scale *= 10.0;
+        }
+        double value = static_cast<double>(mantissa);
+        for (int i = 0; i < droppedDigits; i++) {
+            value *= 10.0;
+        }
+        return value / scale;
+    }
+
+    constexpr size_t slotOf(std::string_view name) {
+        for (size_t i = 0; i < m_program.variableCount; i++) {
+            if (m_program.variables[i] == name) {
+                return i;
+            }
+        }
+        m_program.variables[m_program.variableCount] = name;
+        return m_program.variableCount++;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Parse a literal into a program; throws (a compile error in constant evaluation) if it is malformed
+ */
+template <size_t N>
+constexpr Program<N> parse(const char (&text)[N]) {
+    return detail::Parser<N>(std::string_view(text, N - 1)).parse();
+}
+
+/**
+ * @brief Value of a literal without variables
+ */
+template <size_t N>
+constexpr double evaluate(const char (&text)[N]) {
+    Program<N> program = parse(text);
+    if (!program.isConstant()) {
+        throw std::invalid_argument("Expression is not a compile-time constant");
+    }
+    return program.code[0].value;
+}
+
+/**
+ * @brief A parsed literal evaluated by code unrolled from its program; create with CALCULATOR_FORMULA
+ * @tparam Source Type whose static constexpr program() returns the Program
+ */
+template <typename Source>
+class Formula {
+public:
+    static constexpr auto kProgram = Source::program();
+
+    /**
+     * @brief Number of values evaluate() expects
+     */
+    static constexpr size_t kVariables = kProgram.variableCount;
+
+    /**
+     * @brief Names of the variables, in binding order
+     */
+    static constexpr std::string_view variable(size_t slot) { return kProgram.variables[slot]; }
+
+    /**
+     * @brief Evaluate without throwing
+     * @return The value, or Division by zero with the offset of the '/' in the literal
+     */
+    template <typename... Values>
+    CalcResult tryEvaluate(Values... values) const {
+        static_assert(sizeof...(Values) == kVariables, "Formula expects one value per variable");
+        const double bound[] = {static_cast<double>(values)..., 0.0};
+        double stack[kProgram.maxDepth];
+        CalcResult result;
+        if (run(stack, bound, result, std::make_index_sequence<kProgram.size>{})) {
+            result = CalcResult::success(stack[0]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Evaluate with one value per variable
+     * @throws std::runtime_error on division by zero
+     */
+    template <typename... Values>
+    double evaluate(Values... values) const {
+        CalcResult result = tryEvaluate(values...);
+        if (!result.ok()) {
+            throw std::runtime_error(errorName(result.error));
+        }
+        return result.value;
+    }
+
+private:
+    template <size_t... I>
+    static bool run(double* stack, const double* values, CalcResult& result, std::index_sequence<I...>) {
+        return (step<I>(stack, values, result) && ...);
+    }
+
+    // Every index below is a compile-time constant, so the stack lives in registers
+    template <size_t I>
+    static bool step(double* stack, const double* values, CalcResult& result) {
+        constexpr Instruction instruction = kProgram.code[I];
+        constexpr size_t top = instruction.depth;
+        if constexpr (instruction.op == Op::Constant) {
+            stack[top] = instruction.value;
+        } else if constexpr (instruction.op == Op::Variable) {
+            stack[top] = values[instruction.slot];
+        } else if constexpr (instruction.op == Op::Negate) {
+            stack[top - 1] = -stack[top - 1];
+        } else if constexpr (instruction.op == Op::Add) {
+            stack[top - 2] = stack[top - 2] + stack[top - 1];
+        } else if constexpr (instruction.op == Op::Subtract) {
+            stack[top - 2] = stack[top - 2] - stack[top - 1];
+        } else if constexpr (instruction.op == Op::Multiply) {
+            stack[top - 2] = stack[top - 2] * stack[top - 1];
+        } else if constexpr (instruction.op == Op::Divide) {
+            if (stack[top - 1] == 0) {
+                result = CalcResult::failure(CalcError::DivisionByZero, instruction.position);
+                return false;
+            }
+            stack[top - 2] = stack[top - 2] / stack[top - 1];
+        } else {
+            stack[top - 2] = power_kernels::pow(stack[top - 2], stack[top - 1]);
+        }
+        return true;
+    }
+};
+
+} // namespace calculator_constexpr
+
+/**
+ * @brief The value of a constant literal, computed by the compiler; a malformed literal fails to compile
+ */
+#define CALCULATOR_CONSTANT(text)                                                                                \
+    ([] {                                                                                                       \
+        constexpr double calculatorConstantValue = ::calculator_constexpr::evaluate(text);                      \
+        return calculatorConstantValue;                                                                         \
+    }())
+
+/**
+ * @brief A calculator_constexpr::Formula for a literal that may contain variables
+ */
+#define CALCULATOR_FORMULA(text)                                                                                 \
+    ([] {                                                                                                       \
+        struct CalculatorFormulaSource {                                                                        \
+            static constexpr auto program() { return ::calculator_constexpr::parse(text); }                     \
+        };                                                                                                      \
+        return ::calculator_constexpr::Formula<CalculatorFormulaSource>{};                                      \
+    }())
+
+#endif // CALCULATOR_CONSTEXPR_EXPRESSION_H
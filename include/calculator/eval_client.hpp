@@ -0,0 +1,62 @@
+#ifndef EVAL_CLIENT_H
+#define EVAL_CLIENT_H
+
+#include "calculator/eval_protocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @class EvalClient
+ * @brief Blocking client for EvalServer (Linux only) that pipelines requests
+ *
+ * send() only encodes into a buffer; flush() writes everything buffered in as few system calls as the socket
+ * allows, and receive() reads responses in large chunks and hands them out one at a time.
+ */
+class EvalClient {
+public:
+    /**
+     * @throws std::runtime_error if the server cannot be reached
+     */
+    explicit EvalClient(const std::string& socketPath);
+    ~EvalClient();
+
+    // Delete copy/move operations since the client owns its socket
+    EvalClient(const EvalClient&) = delete;
+    EvalClient(EvalClient&&) = delete;
+    EvalClient& operator=(const EvalClient&) = delete;
+    EvalClient& operator=(EvalClient&&) = delete;
+
+    /**
+     * @brief Queue a request; nothing is written until flush() or receive()
+     */
+    void send(uint32_t id, std::string_view expression);
+
+    /**
+     * @brief Write every queued request
+     * @throws std::runtime_error if the connection fails
+     */
+    void flush();
+
+    /**
+     * @brief Flush, then wait for the next response
+     * @return false once the server has closed the connection
+     * @throws std::runtime_error if the connection fails or the server sends a malformed frame
+     */
+    bool receive(eval_protocol::Response& response);
+
+    /**
+     * @brief Send raw bytes, bypassing the encoder; for exercising the server's handling of bad input
+     */
+    void sendRaw(std::string_view bytes);
+
+private:
+    int m_fd = -1;
+    std::string m_out;
+    std::string m_in;
+    size_t m_inStart = 0; // Bytes of m_in already handed out
+};
+
+#endif // EVAL_CLIENT_H
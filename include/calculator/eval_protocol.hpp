@@ -0,0 +1,74 @@
+#ifndef EVAL_PROTOCOL_H
+#define EVAL_PROTOCOL_H
+
+#include "calculator/calc_result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Wire format spoken by calculator_daemon and its clients
+ *
+ * Every frame is a little-endian uint32 payload length followed by the payload, so a reader can split a
+ * stream into frames without looking inside them. A request payload is a uint32 id chosen by the client and
+ * the expression bytes. A response payload is the request's id, the CalcError code (uint8), the error position
+ * (uint32) and the value (IEEE-754 double, little-endian). Clients may pipeline any number of requests without
+ * waiting; responses carry the id of their request and may arrive in any order.
+ */
+namespace eval_protocol {
+
+/**
+ * @brief Bytes in the length prefix
+ */
+constexpr size_t kLengthBytes = 4;
+
+/**
+ * @brief Payload bytes of a response
+ */
+constexpr size_t kResponsePayload = 4 + 1 + 4 + 8;
+
+/**
+ * @brief Longest request payload a server accepts; a longer frame is a protocol error
+ */
+constexpr size_t kMaxRequestPayload = 1 << 20;
+
+struct Request {
+    uint32_t id;
+    std::string_view expression; // Points into the buffer the request was parsed from
+};
+
+struct Response {
+    uint32_t id;
+    CalcResult result;
+};
+
+/**
+ * @brief Outcome of parsing the front of a buffer
+ */
+enum class ParseStatus : uint8_t {
+    Complete,   // A frame was parsed; consume its bytes
+    Incomplete, // More bytes are needed
+    Invalid     // The stream is corrupt and cannot be resynchronized
+};
+
+void appendRequest(std::string& out, uint32_t id, std::string_view expression);
+
+void appendResponse(std::string& out, uint32_t id, const CalcResult& result);
+
+/**
+ * @brief Parse one request frame from the front of [data, data + size)
+ * @param consumed Set to the frame's size in bytes when the result is Complete
+ */
+ParseStatus parseRequest(const char* data, size_t size, Request& request, size_t& consumed);
+
+/**
+ * @brief Parse one response frame from the front of [data, data + size)
+ * @param consumed Set to the frame's size in bytes when the result is Complete
+ */
+ParseStatus parseResponse(const char* data, size_t size, Response& response, size_t& consumed);
+
+} // namespace eval_protocol
+
+#endif // EVAL_PROTOCOL_H
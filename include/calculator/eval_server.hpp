@@ -0,0 +1,111 @@
+#ifndef EVAL_SERVER_H
+#define EVAL_SERVER_H
+
+#include "calculator/eval_protocol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class EvalServer
+ * @brief Serves CalculatorCore evaluation over a Unix domain socket (Linux only; see eval_protocol.hpp)
+ *
+ * I/O threads each run an epoll loop over their own connections and share the listening socket. They read
+ * whatever a client has pipelined, split it into frames, and hand the requests to the worker pool in batches of
+ * up to Options::maxBatch, so a deep pipeline costs one queue operation per batch rather than per request.
+ * Workers each own a CalculatorCore, which stays warm across clients, and encode the responses into the batch.
+ * Finished batches return to their I/O thread through a queue and an eventfd; the I/O thread writes them out
+ * when the socket accepts them. A connection stops being read while kMaxPendingRequests of its requests, or
+ * kMaxPendingRequestBytes of their expressions, are unanswered, or kMaxUnsentBytes of its responses are waiting
+ * for the socket, so neither large requests nor a client that never reads its responses can grow the server
+ * without bound.
+ */
+class EvalServer {
+public:
+    struct Options {
+        std::string socketPath;
+        size_t ioThreads = 1;
+        size_t workerThreads = 0; // 0 uses std::thread::hardware_concurrency()
+        size_t maxBatch = 64;     // Requests per unit of work handed to a worker
+    };
+
+    /**
+     * @brief Unanswered requests per connection beyond which it is no longer read
+     */
+    static constexpr size_t kMaxPendingRequests = 16384;
+
+    /**
+     * @brief Expression bytes of unanswered requests per connection beyond which it is no longer read
+     */
+    static constexpr size_t kMaxPendingRequestBytes = 16 * eval_protocol::kMaxRequestPayload;
+
+    /**
+     * @brief Encoded responses per connection waiting to be sent beyond which it is no longer read
+     */
+    static constexpr size_t kMaxUnsentBytes =
+        kMaxPendingRequests * (eval_protocol::kLengthBytes + eval_protocol::kResponsePayload);
+
+    /**
+     * @brief Bind the socket and start serving
+     * @details A stale socket file left by a crashed server is replaced; a live one is not.
+     * @throws std::runtime_error if the socket cannot be created, bound, or is served by another process
+     */
+    explicit EvalServer(Options options);
+    ~EvalServer();
+
+    // Delete copy/move operations since the threads hold a pointer back to the server
+    EvalServer(const EvalServer&) = delete;
+    EvalServer(EvalServer&&) = delete;
+    EvalServer& operator=(const EvalServer&) = delete;
+    EvalServer& operator=(EvalServer&&) = delete;
+
+    /**
+     * @brief Close every connection, stop the threads and remove the socket file; safe to call twice
+     */
+    void stop();
+
+    /**
+     * @brief Number of requests evaluated so far
+     */
+    uint64_t requestsServed() const { return m_served.load(std::memory_order_relaxed); }
+
+private:
+    struct Job;
+    struct Connection;
+    struct IoThread;
+
+    Options m_options;
+    int m_listenFd = -1;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint64_t> m_served{0};
+
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueWake;
+    std::deque<std::unique_ptr<Job>> m_queue;
+    bool m_workersStopping = false;
+
+    std::vector<std::unique_ptr<IoThread>> m_ioThreads;
+    std::vector<std::thread> m_workers;
+
+    void bindListener();
+    void ioLoop(IoThread& io);
+    void workerLoop();
+
+    void accept(IoThread& io);
+    void readFrom(IoThread& io, Connection& connection);
+    void splitFrames(IoThread& io, Connection& connection, std::unique_ptr<Job>& job);
+    void flush(Connection& connection);
+    void submit(std::unique_ptr<Job>& job);
+    void drainCompleted(IoThread& io);
+    void settle(IoThread& io, Connection& connection);
+};
+
+#endif // EVAL_SERVER_H
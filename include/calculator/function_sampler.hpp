@@ -0,0 +1,122 @@
+#ifndef FUNCTION_SAMPLER_H
+#define FUNCTION_SAMPLER_H
+
+#include "calculator/batch_evaluator.hpp"
+#include "calculator/compiled_expression.hpp"
+#include "calculator/result_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FunctionSampler
+ * @brief Samples a one-variable expression for plotting, with adaptive refinement and a tile cache
+ *
+ * The x axis is cut into tiles of kTileSamples evenly spaced samples. Spacing is a power of two chosen from the
+ * requested resolution, so tiles keep their exact sample positions as the view pans, and zooming reuses them
+ * until the spacing crosses the next power of two. Each tile is evaluated in one BatchEvaluator call and then
+ * refined: spans whose midpoint strays from a straight line, or that border a failed sample, are bisected
+ * in vectorized passes up to kMaxRefineDepth times. Tiles are kept in an LRU cache, so redrawing or panning
+ * only evaluates newly exposed tiles.
+ */
+class FunctionSampler {
+public:
+    /**
+     * @brief A sample; y is NaN where evaluation failed (e.g. division by zero), so plots break into gaps
+     */
+    struct Point {
+        double x;
+        double y;
+    };
+
+    /**
+     * @brief Base samples per tile, one evaluation block
+     */
+    static constexpr size_t kTileSamples = BatchEvaluator::kBlockSize;
+
+    /**
+     * @brief Bisection passes per tile; each halves the spacing where the curve still bends
+     */
+    static constexpr int kMaxRefineDepth = 6;
+
+    /**
+     * @brief Deviation from a straight line, as a fraction of the tile's value range, that triggers refinement
+     */
+    static constexpr double kRefineTolerance = 1.0 / 1024;
+
+    /**
+     * @param expression A program with at most one variable, which becomes the horizontal axis
+     * @param cacheTiles Maximum number of sampled tiles kept for reuse
+     * @throws std::runtime_error if the expression uses more than one variable
+     */
+    explicit FunctionSampler(CompiledExpression expression, size_t cacheTiles = 512);
+
+    /**
+     * @brief Sample the function across [xMin, xMax]
+     * @param resolution Minimum number of base samples across the range, typically the plot width in pixels
+     * @param points Output, cleared first; sorted by x and covering at least the range, nothing if it is empty
+     */
+    void sample(double xMin, double xMax, size_t resolution, std::vector<Point>& points);
+
+    /**
+     * @brief Tile cache hits, misses and evictions
+     */
+    const CacheStats& stats() const { return m_stats; }
+
+    /**
+     * @brief Number of function evaluations so far, base samples and refinements
+     */
+    uint64_t samplesEvaluated() const { return m_samplesEvaluated; }
+
+    size_t cachedTiles() const { return m_tiles.size(); }
+
+private:
+    struct TileKey {
+        int level; // Sample spacing is 2^level
+        int64_t index;
+
+        bool operator==(const TileKey& other) const { return level == other.level && index == other.index; }
+    };
+
+    struct TileKeyHash {
+        size_t operator()(const TileKey& key) const {
+            return std::hash<int64_t>{}(key.index * 131 + key.level);
+        }
+    };
+
+    struct Tile {
+        TileKey key;
+        std::vector<Point> points; // Base and refined samples, sorted by x; the last is the next tile's first
+    };
+
+    /**
+     * @brief A span between adjacent samples that may need bisecting
+     */
+    struct Span {
+        Point left;
+        Point right;
+    };
+
+    BatchEvaluator m_evaluator;
+    size_t m_capacity;
+    std::list<Tile> m_tiles; // Most recently used first
+    std::unordered_map<TileKey, std::list<Tile>::iterator, TileKeyHash> m_index;
+    CacheStats m_stats;
+    uint64_t m_samplesEvaluated = 0;
+
+    // Scratch reused across tiles
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<Span> m_spans;
+    std::vector<Span> m_nextSpans;
+
+    const Tile& tile(TileKey key);
+    void computeTile(Tile& tile);
+    void evaluate(size_t count);
+};
+
+#endif // FUNCTION_SAMPLER_H
@@ -0,0 +1,86 @@
+#ifndef FUNCTION_TABLE_H
+#define FUNCTION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FunctionTable
+ * @brief Functions callable from expressions, interned to dense integer ids
+ *
+ * Names are resolved once, when an expression is parsed or compiled; evaluation then indexes the table by id
+ * and calls through a plain function pointer, so a call costs one indirect branch and no string work. Built-in
+ * functions take the first ids, in the order of a static table sorted by name and searched by bisection;
+ * functions added later take the following ids.
+ */
+class FunctionTable {
+public:
+    /**
+     * @brief Implementation of a function; receives exactly its arity arguments, in source order
+     * @details Must be pure: the optimizer folds calls whose arguments are constant.
+     */
+    using Callback = double (*)(const double* arguments);
+
+    struct Function {
+        std::string_view name;
+        Callback call;
+        uint8_t arity;
+    };
+
+    /**
+     * @brief Largest number of arguments a function can take
+     */
+    static constexpr size_t kMaxArity = 8;
+
+    /**
+     * @brief Never a valid id, for marking "not a function"
+     */
+    static constexpr uint16_t kNoFunction = UINT16_MAX;
+
+    /**
+     * @brief A table holding only the built-in functions
+     */
+    FunctionTable();
+
+    // Function names view into the table's own storage
+    FunctionTable(const FunctionTable&) = delete;
+    FunctionTable(FunctionTable&&) = delete;
+    FunctionTable& operator=(const FunctionTable&) = delete;
+    FunctionTable& operator=(FunctionTable&&) = delete;
+
+    /**
+     * @brief Shared table of the built-in functions
+     */
+    static const FunctionTable& builtins();
+
+    /**
+     * @brief Add a function taking exactly @p arity arguments
+     * @return The id of the new function
+     * @throws std::runtime_error if @p name is not an identifier or is already defined, or @p arity is 0 or
+     *         above kMaxArity, or the table is full
+     */
+    uint16_t add(std::string_view name, size_t arity, Callback call);
+
+    /**
+     * @brief Looks up the id of a function
+     * @return The id, or std::nullopt if no function has that name
+     */
+    std::optional<uint16_t> find(std::string_view name) const;
+
+    const Function& operator[](uint16_t id) const { return m_functions[id]; }
+
+    size_t size() const { return m_functions.size(); }
+
+private:
+    std::vector<Function> m_functions; // Indexed by id
+    std::deque<std::string> m_names;   // Names of the functions added after the built-ins
+    std::unordered_map<std::string_view, uint16_t> m_added;
+};
+
+#endif // FUNCTION_TABLE_H
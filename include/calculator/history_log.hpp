@@ -0,0 +1,99 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include "calculator/calc_result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @class HistoryLog
+ * @brief Persistent, append-only log of calculations, memory-mapped for O(1) append and random access
+ *
+ * The log is two files. @c path holds a fixed header (entry count, text size, memory register) followed by
+ * fixed-size records. @c path.text holds the expressions the records point into. Opening the log reads only the
+ * header, so startup cost does not depend on its length. Both mappings grow geometrically, so appends are
+ * amortized O(1). An append writes the text and record first and then publishes the new counts in the header,
+ * so an append cut short by a crash is simply not part of the log. An exclusive lock keeps a second process
+ * from writing the same log.
+ */
+class HistoryLog {
+public:
+    /**
+     * @brief A logged calculation; the expression views into the mapping and is valid until the next append
+     */
+    struct Entry {
+        int64_t timestamp; // Milliseconds since the Unix epoch
+        double value;      // The result, when error is CalcError::None
+        CalcError error;
+        std::string_view expression;
+    };
+
+    /**
+     * @brief Open the log at @p path, creating it if it does not exist
+     * @throws std::runtime_error if the files cannot be opened or mapped, are locked by another process, or are
+     *         not a valid log
+     */
+    explicit HistoryLog(const std::string& path);
+    ~HistoryLog();
+
+    // Delete copy/move operations since the log owns its mappings and lock
+    HistoryLog(const HistoryLog&) = delete;
+    HistoryLog(HistoryLog&&) = delete;
+    HistoryLog& operator=(const HistoryLog&) = delete;
+    HistoryLog& operator=(HistoryLog&&) = delete;
+
+    /**
+     * @brief Record a calculation, timestamped now
+     * @throws std::runtime_error if the log cannot grow; the log is then unchanged and still usable
+     */
+    void append(std::string_view expression, const CalcResult& result);
+
+    /**
+     * @brief Record a calculation with an explicit timestamp, in milliseconds since the Unix epoch
+     * @throws std::runtime_error if the log cannot grow
+     */
+    void append(std::string_view expression, const CalcResult& result, int64_t timestamp);
+
+    /**
+     * @brief Number of entries
+     */
+    size_t size() const;
+
+    /**
+     * @brief The entry at @p index, oldest first; @p index must be less than size()
+     */
+    Entry operator[](size_t index) const;
+
+    /**
+     * @brief The persisted memory register
+     */
+    double memory() const;
+
+    void setMemory(double value);
+
+private:
+    struct Header;
+    struct Record;
+
+    struct MappedFile {
+        int fd = -1;
+        char* data = nullptr;
+        size_t capacity = 0;
+    };
+
+    MappedFile m_records; // Header followed by fixed-size records
+    MappedFile m_text;    // Expression bytes, referenced by offset from the records
+
+    Header* header() const;
+    Record* records() const;
+
+    static void openFile(MappedFile& file, const std::string& path);
+    static void map(MappedFile& file, size_t capacity);
+    static void reserve(MappedFile& file, size_t bytes);
+    static void closeFile(MappedFile& file);
+};
+
+#endif // HISTORY_LOG_H
@@ -0,0 +1,126 @@
+#ifndef INCREMENTAL_EVALUATOR_H
+#define INCREMENTAL_EVALUATOR_H
+
+#include "calculator/calc_result.hpp"
+#include "calculator/function_table.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class IncrementalEvaluator
+ * @brief Evaluates an expression as it is typed, one character at a time
+ *
+ * Operators are reduced as soon as precedence allows, exactly as the shunting-yard pipeline would
+ * reduce them, so a complete expression yields the same value as CalculatorCore::calculate. A function
+ * call is a '(' that remembers its function and argument count, and is applied at its ')'. The value
+ * and operator stacks are persistent linked lists in append-only node pools, and the parser state after
+ * every character is kept: pop() restores the previous state and discards the nodes created since.
+ * Appending or removing a character therefore costs O(1) amortized, and preview() folds only the operators
+ * still pending. Those are usually few, but right-associative '^' chains and unary-minus chains stay pending
+ * until they end, so previewing "2^2^2^..." or "----...1" is linear in the chain length.
+ */
+class IncrementalEvaluator {
+public:
+    /**
+     * @brief What the buffer currently evaluates to
+     */
+    struct Preview {
+        enum Status : uint8_t {
+            Empty,    // Nothing typed yet
+            Complete, // A full expression; value is its result
+            Partial,  // Mid-entry (trailing operator or open parenthesis); value, if any, is what is complete so far
+            Invalid   // No continuation can make the expression valid, or evaluation fails; see error
+        };
+        Status status = Empty;
+        bool hasValue = false;
+        double value = 0.0;
+        CalcResult error; // Set when status is Invalid
+    };
+
+    /**
+     * @param functions Resolves function calls; must outlive the evaluator
+     */
+    explicit IncrementalEvaluator(const FunctionTable& functions = FunctionTable::builtins());
+
+    /**
+     * @brief Append characters to the buffer
+     */
+    void push(std::string_view characters);
+
+    /**
+     * @brief Remove the last character, if any
+     */
+    void pop();
+
+    /**
+     * @brief Empty the buffer
+     */
+    void clear();
+
+    /**
+     * @brief Replace the buffer, reprocessing only what differs from the current one after their common prefix
+     */
+    void assign(std::string_view text);
+
+    const std::string& text() const { return m_text; }
+
+    Preview preview() const;
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct ValueNode {
+        double value;
+        uint32_t next;
+    };
+
+    struct OperatorNode {
+        char op;           // Binary operator, '~' for unary minus, or '('
+        uint8_t arguments; // For a call's '(': arguments completed so far
+        uint16_t function; // For a call's '(': the function's id; FunctionTable::kNoFunction otherwise
+        uint32_t position; // Offset in the buffer, for error reporting
+        uint32_t next;
+    };
+
+    /**
+     * @brief Parser state after a prefix of the buffer; small and trivially copyable
+     */
+    struct State {
+        uint32_t values = kNil;     // Top of the value stack
+        uint32_t operators = kNil;  // Top of the operator stack
+        uint32_t valueCount = 0;    // Pool sizes when this state was recorded
+        uint32_t operatorCount = 0;
+        uint32_t tokenStart = kNil; // Start of the number or identifier being typed
+        uint32_t openParentheses = 0;
+        bool expectOperand = true;
+        bool sawToken = false;
+        CalcResult error;     // Syntax error; once set, no continuation can recover
+        CalcResult evalError; // First evaluation error, in evaluation order
+    };
+
+    const FunctionTable* m_functions;
+    std::string m_text;
+    std::vector<State> m_states; // m_states[i] is the state after the first i characters
+    std::vector<ValueNode> m_values;
+    std::vector<OperatorNode> m_operators;
+
+    void process(State& state, char c, uint32_t position);
+    void finishToken(State& state, uint32_t end);
+    void startCall(State& state, uint32_t position);
+    void separate(State& state, uint32_t position);
+    void reduce(State& state);
+    uint32_t pushValue(double value, uint32_t next);
+    void pushOperator(State& state, char op, uint32_t position, uint16_t function = FunctionTable::kNoFunction,
+                      uint8_t arguments = 0);
+
+    /**
+     * @brief Call @p function with @p last as its final argument and the values from @p values down as the others
+     * @param values Top of the remaining value stack; advanced past the arguments taken from it
+     */
+    double call(const FunctionTable::Function& function, double last, uint32_t& values) const;
+};
+
+#endif // INCREMENTAL_EVALUATOR_H
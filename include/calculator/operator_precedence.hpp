@@ -0,0 +1,31 @@
+#ifndef CALCULATOR_OPERATOR_PRECEDENCE_H
+#define CALCULATOR_OPERATOR_PRECEDENCE_H
+
+/**
+ * @brief Precedence table shared by every parser of the calculator grammar
+ * @param op A binary operator, or '~' for unary minus
+ * @return Precedence level (higher = earlier evaluation), 0 for anything else
+ */
+constexpr int operatorPrecedence(char op) {
+    switch (op) {
+    case '^':
+        return 5;
+    case '~':
+        return 4;
+    case '*':
+    case '/':
+        return 3;
+    case '+':
+    case '-':
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Whether a binary operator groups right to left, so that 2^3^2 == 2^(3^2)
+ */
+constexpr bool operatorIsRightAssociative(char op) { return op == '^'; }
+
+#endif // CALCULATOR_OPERATOR_PRECEDENCE_H
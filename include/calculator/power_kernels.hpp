@@ -0,0 +1,134 @@
+#ifndef CALCULATOR_POWER_KERNELS_H
+#define CALCULATOR_POWER_KERNELS_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Strength-reduced replacements for std::pow, used for every '^' the core evaluates
+ *
+ * Common exponents are dispatched to a few multiplies, a square root or an exact scaling instead of the
+ * general logarithm-based std::pow. Results keep std::pow's handling of zeros, infinities and NaN.
+ */
+namespace power_kernels {
+
+/**
+ * @brief Accuracy tiers, measured against std::pow
+ */
+enum class Accuracy : uint8_t {
+    Faithful, // Within 1 ULP: exponents 0, 1, 2, 3, 0.5, -1, and integer powers of two (exact)
+    Fast      // Also integer exponents up to kMaxSquaringExponent by squaring, within |exponent| + 1 ULPs
+};
+
+/**
+ * @brief Tier used by the core; Fast when the library is built with CALCULATOR_FAST_POW
+ */
+#if defined(CALCULATOR_FAST_POW) && CALCULATOR_FAST_POW
+constexpr Accuracy kDefaultAccuracy = Accuracy::Fast;
+#else
+constexpr Accuracy kDefaultAccuracy = Accuracy::Faithful;
+#endif
+
+/**
+ * @brief Largest |exponent| evaluated by squaring in the Fast tier; the error grows with the exponent
+ */
+constexpr int64_t kMaxSquaringExponent = 32;
+
+inline double square(double base) { return base * base; }
+
+inline double cube(double base) { return base * base * base; }
+
+inline double reciprocal(double base) { return 1.0 / base; }
+
+/**
+ * @brief pow(base, 0.5): unlike std::sqrt, -0 gives +0 and -inf gives +inf
+ */
+inline double squareRoot(double base) {
+    if (base == 0.0 || std::isinf(base)) {
+        return std::fabs(base);
+    }
+    return std::sqrt(base);
+}
+
+/**
+ * @brief 2^exponent for an integer exponent, exact including overflow to inf and underflow to subnormals
+ */
+inline double powerOfTwo(int exponent) {
+    if (exponent < -1022 || exponent > 1023) {
+        return std::ldexp(1.0, exponent);
+    }
+    // Normal results are just a biased exponent field
+    uint64_t bits = static_cast<uint64_t>(exponent + 1023) << 52;
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/**
+ * @brief base^exponent by binary exponentiation; a negative exponent takes the reciprocal of the result
+ * @details When that intermediate power overflows or leaves the normal range, the reciprocal would be
+ *          off by far more than the rounding error, so std::pow computes it instead.
+ */
+inline double integerPower(double base, int64_t exponent) {
+    uint64_t remaining = exponent < 0 ? 0 - static_cast<uint64_t>(exponent) : static_cast<uint64_t>(exponent);
+    double result = 1.0;
+    double factor = base;
+    while (remaining != 0) {
+        if (remaining & 1) {
+            result *= factor;
+        }
+        remaining >>= 1;
+        if (remaining != 0) {
+            factor *= factor;
+        }
+    }
+    if (exponent >= 0) {
+        return result;
+    }
+    return std::isnormal(result) ? 1.0 / result : std::pow(base, static_cast<double>(exponent));
+}
+
+/**
+ * @brief Drop-in replacement for std::pow
+ * @param accuracy Which kernels may be used; exponents without a kernel fall back to std::pow
+ */
+inline double pow(double base, double exponent, Accuracy accuracy = kDefaultAccuracy) {
+    // Ordered by how often each exponent appears in practice
+    if (exponent == 2.0) {
+        return square(base);
+    }
+    if (exponent == 3.0) {
+        return cube(base);
+    }
+    if (exponent == 0.5) {
+        return squareRoot(base);
+    }
+    if (exponent == -1.0) {
+        return reciprocal(base);
+    }
+    if (exponent == 1.0) {
+        return base;
+    }
+    if (exponent == 0.0) {
+        return 1.0; // Even for NaN, as std::pow specifies
+    }
+
+    // Beyond +-2048 every power of two is inf or 0 anyway, so the range check keeps the cast defined
+    if (exponent >= -2048.0 && exponent <= 2048.0) {
+        auto integral = static_cast<int>(exponent);
+        if (integral == exponent) {
+            if (base == 2.0) {
+                return powerOfTwo(integral);
+            }
+            if (accuracy == Accuracy::Fast && integral >= -kMaxSquaringExponent && integral <= kMaxSquaringExponent) {
+                return integerPower(base, integral);
+            }
+        }
+    }
+    return std::pow(base, exponent);
+}
+
+} // namespace power_kernels
+
+#endif // CALCULATOR_POWER_KERNELS_H
@@ -0,0 +1,101 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class CalculatorCore;
+
+/**
+ * @brief Counters reported by ResultCache::stats
+ */
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+/**
+ * @class ResultCache
+ * @brief Bounded, sharded LRU memoization in front of CalculatorCore::calculate
+ *
+ * Keys are whitespace-normalized expressions. Both results and evaluation errors are cached, so a
+ * repeated invalid expression is rejected without re-parsing; a cancelled evaluation is not cached. Each shard has its own lock, so
+ * concurrent callers only contend when their expressions hash to the same shard.
+ */
+class ResultCache {
+public:
+    /**
+     * @param capacity Maximum number of cached expressions across all shards
+     * @param shards Number of independently locked shards
+     */
+    explicit ResultCache(size_t capacity = 4096, size_t shards = 16);
+    ~ResultCache();
+
+    // Delete copy/move operations since shards own their locks
+    ResultCache(const ResultCache&) = delete;
+    ResultCache(ResultCache&&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+    ResultCache& operator=(ResultCache&&) = delete;
+
+    /**
+     * @brief Return the cached outcome of an expression, evaluating it with @p calculator on a miss
+     * @param calculator The calculator used on a miss; it is not shared between threads by the cache
+     * @param expression The mathematical expression to evaluate
+     * @return The result of the calculation
+     * @throws std::runtime_error with the original message if the expression is invalid or the evaluation is
+     *         cancelled
+     */
+    double calculate(CalculatorCore& calculator, std::string_view expression);
+
+    /**
+     * @brief Snapshot of the hit, miss and eviction counters
+     */
+    CacheStats stats() const;
+
+    /**
+     * @brief Number of cached expressions
+     */
+    size_t size() const;
+
+    /**
+     * @brief Drop every entry; counters are kept
+     */
+    void clear();
+
+    /**
+     * @brief Canonical cache key of an expression
+     * @details Whitespace is removed except where it separates two number or identifier characters, or a
+     *          name from a following '(', where it collapses to one space, so "1 2" and "12" stay distinct, as
+     *          do the variable in "f (2)" and the call in "f(2)".
+     */
+    static void normalize(std::string_view expression, std::string& key);
+
+private:
+    struct Entry {
+        std::string key;
+        double value;
+        std::string error; // Empty when the expression evaluated successfully
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries; // Most recently used first
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+        CacheStats stats;
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    size_t m_shardCapacity;
+
+    static double resolve(const Entry& entry);
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,244 @@
+#include "calculator/calculator_core.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t kBufferSize = 1 << 20;
+
+/**
+ * @brief Accumulates output and writes it in large blocks instead of flushing per line
+ */
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::FILE* file) : m_file(file), m_buffer(kBufferSize) {}
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void append(std::string_view text) {
+        if (m_size + text.size() > m_buffer.size()) {
+            flush();
+            if (text.size() > m_buffer.size()) {
+                write(text.data(), text.size());
+                return;
+            }
+        }
+        std::memcpy(m_buffer.data() + m_size, text.data(), text.size());
+        m_size += text.size();
+    }
+
+    void append(double value) {
+        char digits[32];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, end - digits));
+    }
+
+    void flush() {
+        write(m_buffer.data(), m_size);
+        m_size = 0;
+    }
+
+    bool failed() const { return m_failed; }
+
+private:
+    std::FILE* m_file;
+    std::vector<char> m_buffer;
+    size_t m_size = 0;
+    bool m_failed = false;
+
+    void write(const char* data, size_t size) {
+        if (size > 0 && std::fwrite(data, 1, size, m_file) != size) {
+            m_failed = true;
+        }
+    }
+};
+
+/**
+ * @brief Evaluates one expression and writes either its result or "error: <message>" on its own line
+ */
+void processLine(CalculatorCore& calculator, std::string_view line, OutputBuffer& out) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    CalcResult result = calculator.tryCalculate(line);
+    if (result.ok()) {
+        out.append(result.value);
+    } else {
+        out.append("error: ");
+        out.append(formatError(result, line));
+    }
+    out.append("\n");
+}
+
+/**
+ * @brief Evaluates every line in [data, data + size); a final line without a newline is still evaluated
+ */
+void processLines(CalculatorCore& calculator, const char* data, size_t size, OutputBuffer& out) {
+    const char* end = data + size;
+    while (data < end) {
+        auto* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        const char* lineEnd = newline ? newline : end;
+        processLine(calculator, std::string_view(data, lineEnd - data), out);
+        data = newline ? newline + 1 : end;
+    }
+}
+
+/**
+ * @brief Streams a file in fixed-size chunks, carrying any partial line over to the next read
+ * @return false on read error
+ */
+bool processStream(CalculatorCore& calculator, std::FILE* in, OutputBuffer& out) {
+    std::vector<char> chunk(kBufferSize);
+    std::string carry;
+
+    while (size_t count = std::fread(chunk.data(), 1, chunk.size(), in)) {
+        const char* data = chunk.data();
+        const char* end = data + count;
+
+        if (!carry.empty()) {
+            auto* newline = static_cast<const char*>(std::memchr(data, '\n', count));
+            if (!newline) {
+                carry.append(data, count);
+                continue;
+            }
+            carry.append(data, newline - data);
+            processLine(calculator, carry, out);
+            carry.clear();
+            data = newline + 1;
+        }
+
+        // Lines wholly inside the chunk are evaluated in place; only the unterminated tail is copied
+        const char* lastNewline = end;
+        while (lastNewline > data && lastNewline[-1] != '\n') {
+            lastNewline--;
+        }
+        processLines(calculator, data, lastNewline - data, out);
+        carry.assign(lastNewline, end);
+    }
+
+    if (!carry.empty()) {
+        processLine(calculator, carry, out);
+    }
+    return !std::ferror(in);
+}
+
+/**
+ * @brief Maps a file into memory and evaluates it line by line without copying
+ * @return false if the file cannot be opened or read
+ */
+bool processFile(CalculatorCore& calculator, const char* path, OutputBuffer& out) {
+#if !defined(_WIN32)
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Pipes and special files cannot be mapped; stream them instead
+    if (!S_ISREG(info.st_mode)) {
+        std::FILE* in = ::fdopen(fd, "rb");
+        if (!in) {
+            ::close(fd);
+            return false;
+        }
+        bool ok = processStream(calculator, in, out);
+        std::fclose(in);
+        return ok;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    // Pages are read once in order, so let the kernel read ahead and drop them behind us
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    processLines(calculator, static_cast<const char*>(mapping), size, out);
+    ::munmap(mapping, size);
+    return true;
+#else
+    std::FILE* in = std::fopen(path, "rb");
+    if (!in) {
+        return false;
+    }
+    bool ok = processStream(calculator, in, out);
+    std::fclose(in);
+    return ok;
+#endif
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--stdin | --file <path>] [--engine shunting-yard|pratt]\n"
+              << "Evaluates one expression per line and prints one result per line.\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    CalculatorCore::Engine engine = CalculatorCore::Engine::ShuntingYard;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--stdin") {
+            path = nullptr;
+        } else if (arg == "--file" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc && std::string_view(argv[i + 1]) == "shunting-yard") {
+            engine = CalculatorCore::Engine::ShuntingYard;
+            i++;
+        } else if (arg == "--engine" && i + 1 < argc && std::string_view(argv[i + 1]) == "pratt") {
+            engine = CalculatorCore::Engine::Pratt;
+            i++;
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    try {
+        CalculatorCore calculator;
+        calculator.setEngine(engine);
+        OutputBuffer out(stdout);
+
+        bool ok = path ? processFile(calculator, path, out) : processStream(calculator, stdin, out);
+        out.flush();
+        if (!ok) {
+            std::cerr << "Error: failed to read " << (path ? path : "stdin") << "\n";
+            return 1;
+        }
+        if (out.failed()) {
+            std::cerr << "Error: failed to write output\n";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,80 @@
+#include "calculator/async_evaluator.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <memory>
+#include <utility>
+
+AsyncEvaluator::AsyncEvaluator(std::function<void()> onResult)
+    : m_onResult(std::move(onResult)), m_thread(&AsyncEvaluator::workerLoop, this) {}
+
+AsyncEvaluator::~AsyncEvaluator() {
+    m_stopping.store(true);
+    m_cancel.store(true);
+    wakeWorker();
+    m_thread.join();
+    delete m_request.exchange(nullptr);
+    delete m_response.exchange(nullptr);
+}
+
+void AsyncEvaluator::submit(std::string expression) {
+    uint64_t id = ++m_submitted;
+    // Publish the new id before raising the flag, so a worker that clears the flag for an older request
+    // still sees that request is stale
+    m_latest.store(id);
+    m_cancel.store(true);
+    // Whoever exchanges a request out of the mailbox owns it, including one the worker never took
+    delete m_request.exchange(new Request{id, std::move(expression)});
+    wakeWorker();
+}
+
+void AsyncEvaluator::cancel() {
+    uint64_t id = ++m_submitted;
+    m_latest.store(id);
+    m_cancel.store(true);
+    m_received = id;
+}
+
+bool AsyncEvaluator::poll(CalcResult& result) {
+    std::unique_ptr<Response> response(m_response.exchange(nullptr));
+    if (!response || response->id != m_submitted) {
+        return false;
+    }
+    m_received = response->id;
+    result = response->result;
+    return true;
+}
+
+void AsyncEvaluator::wakeWorker() {
+    // Taking the lock orders the notification after the worker's predicate check, so the wakeup is not lost
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+void AsyncEvaluator::workerLoop() {
+    CalculatorCore calculator;
+    calculator.setCancellationFlag(&m_cancel);
+
+    while (!m_stopping.load()) {
+        std::unique_ptr<Request> request(m_request.exchange(nullptr));
+        if (!request) {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stopping.load() || m_request.load() != nullptr; });
+            continue;
+        }
+
+        m_cancel.store(false);
+        if (m_latest.load() != request->id) {
+            continue; // Superseded or cancelled before it started
+        }
+
+        CalcResult result = calculator.tryCalculate(request->expression);
+        if (result.error == CalcError::Cancelled) {
+            continue;
+        }
+        delete m_response.exchange(new Response{request->id, result});
+        if (m_onResult) {
+            m_onResult();
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include "calculator/batch_calculator.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <utility>
+
+namespace {
+// Items per chunk: large enough to amortize the deque lock, small enough to balance skewed inputs
+constexpr size_t kChunkSize = 64;
+} // namespace
+
+struct BatchCalculator::Worker {
+    std::mutex mutex;
+    std::deque<std::pair<size_t, size_t>> chunks; // Owner pops from the back, thieves steal from the front
+    CalculatorCore core;
+    std::thread thread;
+};
+
+BatchCalculator::BatchCalculator(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        m_workers[i]->thread = std::thread(&BatchCalculator::workerLoop, this, i);
+    }
+}
+
+BatchCalculator::~BatchCalculator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+std::vector<BatchResult> BatchCalculator::calculate(const std::vector<std::string>& expressions) {
+    std::vector<BatchResult> results(expressions.size());
+    if (expressions.empty()) {
+        return results;
+    }
+
+    // Deal contiguous runs of chunks to each worker so that, without stealing, neighbours stay on one core
+    size_t chunkCount = (expressions.size() + kChunkSize - 1) / kChunkSize;
+    size_t perWorker = (chunkCount + m_workers.size() - 1) / m_workers.size();
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        size_t begin = chunk * kChunkSize;
+        size_t end = std::min(begin + kChunkSize, expressions.size());
+        m_workers[chunk / perWorker]->chunks.emplace_back(begin, end);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_input = &expressions;
+    m_output = results.data();
+    m_active = m_workers.size();
+    m_generation++;
+    m_wake.notify_all();
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_input = nullptr;
+    m_output = nullptr;
+
+    return results;
+}
+
+void BatchCalculator::workerLoop(size_t index) {
+    Worker& self = *m_workers[index];
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        size_t begin, end;
+        while (takeChunk(index, begin, end)) {
+            for (size_t i = begin; i < end; i++) {
+                // Only failures pay for building a message
+                CalcResult result = self.core.tryCalculate((*m_input)[i]);
+                m_output[i].value = result.value;
+                if (!result.ok()) {
+                    m_output[i].error = formatError(result, (*m_input)[i]);
+                }
+            }
+        }
+
+        // All chunks are queued before the batch starts, so an empty sweep means this worker is done
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+bool BatchCalculator::takeChunk(size_t index, size_t& begin, size_t& end) {
+    {
+        Worker& self = *m_workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.chunks.empty()) {
+            std::tie(begin, end) = self.chunks.back();
+            self.chunks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < m_workers.size(); offset++) {
+        Worker& victim = *m_workers[(index + offset) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            std::tie(begin, end) = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
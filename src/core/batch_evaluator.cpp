@@ -0,0 +1,177 @@
+#include "calculator/batch_evaluator.hpp"
+
+#include "calculator/calculator_core.hpp"
+#include "builtin_math.hpp"
+#include "simd_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+BatchEvaluator::BatchEvaluator(CompiledExpression expression)
+    : m_expression(std::move(expression)), m_stack(m_expression.m_maxStackDepth * kBlockSize),
+      m_errorMask(kBlockSize) {}
+
+size_t BatchEvaluator::evaluate(const double* const* columns, size_t rows, double* results, unsigned char* errors) {
+    size_t failures = 0;
+    for (size_t offset = 0; offset < rows; offset += kBlockSize) {
+        size_t count = std::min(kBlockSize, rows - offset);
+        evaluateBlock(columns, offset, count);
+
+        const double* top = m_stack.data();
+        for (size_t i = 0; i < count; i++) {
+            bool failed = simd::isMasked(m_errorMask[i]);
+            results[offset + i] = failed ? std::numeric_limits<double>::quiet_NaN() : top[i];
+            if (errors) {
+                errors[offset + i] = failed;
+            }
+            failures += failed;
+        }
+    }
+    return failures;
+}
+
+std::vector<double> BatchEvaluator::evaluate(const std::vector<std::vector<double>>& columns,
+                                             std::vector<unsigned char>* errors) {
+    if (columns.size() < m_expression.m_variables.size()) {
+        throw std::runtime_error("Unbound variable: " + m_expression.m_variables[columns.size()]);
+    }
+
+    size_t rows = columns.empty() ? 1 : columns[0].size();
+    std::vector<const double*> pointers;
+    pointers.reserve(columns.size());
+    for (const auto& column : columns) {
+        if (column.size() != rows) {
+            throw std::runtime_error("Batch columns must have the same length");
+        }
+        pointers.push_back(column.data());
+    }
+
+    std::vector<double> results(rows);
+    if (errors) {
+        errors->assign(rows, 0);
+    }
+    evaluate(pointers.data(), rows, results.data(), errors ? errors->data() : nullptr);
+    return results;
+}
+
+void BatchEvaluator::evaluateBlock(const double* const* columns, size_t offset, size_t count) {
+    using Opcode = CompiledExpression::Opcode;
+
+    std::fill(m_errorMask.begin(), m_errorMask.end(), 0.0);
+
+    // Operands are referenced by pointer so variable columns are read in place; results land in the
+    // scratch block belonging to the operand's stack depth. The compiler already validated the depth.
+    const double* operands[CompiledExpression::kLocalStackSize];
+    std::vector<const double*> spilled;
+    const double** stack = operands;
+    if (m_expression.m_maxStackDepth > std::size(operands)) {
+        spilled.resize(m_expression.m_maxStackDepth);
+        stack = spilled.data();
+    }
+
+    size_t depth = 0;
+    for (uint32_t instruction : m_expression.m_code) {
+        Opcode opcode = CompiledExpression::opcodeOf(instruction);
+        switch (opcode) {
+        case Opcode::Constant: {
+            double* out = m_stack.data() + depth * kBlockSize;
+            simd::fill(out, m_expression.m_constants[CompiledExpression::operandOf(instruction)], count);
+            stack[depth++] = out;
+            break;
+        }
+        case Opcode::Variable:
+            stack[depth++] = columns[CompiledExpression::operandOf(instruction)] + offset;
+            break;
+        case Opcode::Dup:
+            stack[depth] = stack[depth - 1];
+            depth++;
+            break;
+        case Opcode::Negate: {
+            double* out = m_stack.data() + (depth - 1) * kBlockSize;
+            simd::negate(out, stack[depth - 1], count);
+            stack[depth - 1] = out;
+            break;
+        }
+        case Opcode::Abs:
+        case Opcode::Sqrt: {
+            double* out = m_stack.data() + (depth - 1) * kBlockSize;
+            const double* a = stack[depth - 1];
+            if (opcode == Opcode::Abs) {
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = std::fabs(a[i]);
+                }
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = std::sqrt(a[i]);
+                }
+            }
+            stack[depth - 1] = out;
+            break;
+        }
+        case Opcode::Call: {
+            // Functions are opaque callbacks, so each lane is called on its own
+            const CompiledExpression::Function& function =
+                m_expression.m_functions[CompiledExpression::operandOf(instruction)];
+            const double* const* arguments = stack + depth - function.arity;
+            double* out = m_stack.data() + (depth - function.arity) * kBlockSize;
+            double lane[FunctionTable::kMaxArity];
+            for (size_t i = 0; i < count; i++) {
+                for (size_t k = 0; k < function.arity; k++) {
+                    lane[k] = arguments[k][i];
+                }
+                out[i] = function.call(lane);
+            }
+            depth -= function.arity - 1;
+            stack[depth - 1] = out;
+            break;
+        }
+        case Opcode::Return:
+            break; // Always the last instruction
+        default: {
+            double* out = m_stack.data() + (depth - 2) * kBlockSize;
+            const double* a = stack[depth - 2];
+            const double* b = stack[depth - 1];
+            switch (opcode) {
+            case Opcode::Add:
+                simd::add(out, a, b, count);
+                break;
+            case Opcode::Subtract:
+                simd::sub(out, a, b, count);
+                break;
+            case Opcode::Multiply:
+                simd::mul(out, a, b, count);
+                break;
+            case Opcode::Divide:
+                simd::divide(out, a, b, m_errorMask.data(), count);
+                break;
+            case Opcode::Min:
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = builtin_math::min(a[i], b[i]);
+                }
+                break;
+            case Opcode::Max:
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = builtin_math::max(a[i], b[i]);
+                }
+                break;
+            default:
+                // No vector pow exists; fall back to the scalar operator per lane
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = CalculatorCore::applyOperation('^', a[i], b[i]).value;
+                }
+                break;
+            }
+            stack[--depth - 1] = out;
+            break;
+        }
+        }
+    }
+
+    // Make sure the result always lives in the first scratch block, even for a lone variable
+    if (stack[0] != m_stack.data()) {
+        std::copy(stack[0], stack[0] + count, m_stack.data());
+    }
+}
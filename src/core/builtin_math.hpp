@@ -0,0 +1,19 @@
+#ifndef CALCULATOR_BUILTIN_MATH_H
+#define CALCULATOR_BUILTIN_MATH_H
+
+/**
+ * @brief The min and max built-ins, shared by their callbacks and their dedicated opcodes so both agree bit for bit
+ *
+ * std::fmin and std::fmax give the same results but are called out of line, since their NaN rules do not map to
+ * a single instruction; these compile to a compare and a select. A NaN argument is ignored, and of two equal
+ * arguments (such as -0 and +0) the second is returned.
+ */
+namespace builtin_math {
+
+inline double min(double a, double b) { return a < b || b != b ? a : b; }
+
+inline double max(double a, double b) { return a > b || b != b ? a : b; }
+
+} // namespace builtin_math
+
+#endif // CALCULATOR_BUILTIN_MATH_H
@@ -0,0 +1,78 @@
+#include "calculator/calc_result.hpp"
+
+#include <cctype>
+#include <string>
+
+namespace {
+// The run of characters starting at position that satisfy the predicate
+template <typename Predicate>
+std::string_view spanAt(std::string_view expression, uint32_t position, Predicate predicate) {
+    if (position >= expression.size()) {
+        return {};
+    }
+    size_t end = position;
+    while (end < expression.size() && predicate(static_cast<unsigned char>(expression[end]))) {
+        end++;
+    }
+    return expression.substr(position, end - position);
+}
+} // namespace
+
+const char* errorName(CalcError error) {
+    switch (error) {
+    case CalcError::None:
+        return "No error";
+    case CalcError::EmptyExpression:
+        return "Empty expression";
+    case CalcError::InvalidCharacter:
+        return "Invalid character in expression";
+    case CalcError::InvalidNumber:
+        return "Invalid number";
+    case CalcError::MismatchedParentheses:
+        return "Mismatched parentheses";
+    case CalcError::NotEnoughOperands:
+        return "Invalid expression: not enough operands";
+    case CalcError::TooManyOperands:
+        return "Invalid expression: too many operands";
+    case CalcError::DivisionByZero:
+        return "Division by zero";
+    case CalcError::UnboundVariable:
+        return "Unbound variable";
+    case CalcError::UnknownOperator:
+        return "Unknown operator";
+    case CalcError::Cancelled:
+        return "Evaluation cancelled";
+    case CalcError::UnknownFunction:
+        return "Unknown function";
+    case CalcError::WrongArgumentCount:
+        return "Wrong number of function arguments";
+    case CalcError::Count:
+        break;
+    }
+    return "Unknown error";
+}
+
+std::string formatError(const CalcResult& result, std::string_view expression) {
+    std::string message = errorName(result.error);
+    std::string_view detail;
+    switch (result.error) {
+    case CalcError::InvalidCharacter:
+    case CalcError::UnknownOperator:
+        detail = result.position < expression.size() ? expression.substr(result.position, 1) : std::string_view();
+        break;
+    case CalcError::InvalidNumber:
+        detail = spanAt(expression, result.position, [](unsigned char c) { return isdigit(c) || c == '.'; });
+        break;
+    case CalcError::UnboundVariable:
+    case CalcError::UnknownFunction:
+        detail = spanAt(expression, result.position, [](unsigned char c) { return isalnum(c) || c == '_'; });
+        break;
+    default:
+        break;
+    }
+    if (!detail.empty()) {
+        message += ": ";
+        message += detail;
+    }
+    return message;
+}
@@ -1,9 +1,16 @@
 #include "calculator/calculator_core.hpp"
 
+#include "calculator/operator_precedence.hpp"
+#include "calculator/power_kernels.hpp"
+#include "expression_optimizer.hpp"
+#include "pratt_parser.hpp"
+#include "stats_recorder.hpp"
+
+#include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <cmath>
-#include <queue>
-#include <stack>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -12,141 +19,407 @@ CalculatorCore::CalculatorCore() {}
 
 CalculatorCore::~CalculatorCore() {}
 
-double CalculatorCore::calculate(const std::string& expression) {
-    auto tokens = tokenize(expression);
-    auto rpn = shuntingYard(tokens);
-    return evaluatePostfix(rpn);
+double CalculatorCore::calculate(std::string_view expression) {
+    CalcResult result = tryCalculate(expression);
+    if (!result.ok()) {
+        throw std::runtime_error(formatError(result, expression));
+    }
+    return result.value;
 }
 
-bool CalculatorCore::isOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '/' || c == '^'; }
+CalcResult CalculatorCore::tryCalculate(std::string_view expression) {
+    if (m_engine == Engine::Pratt) {
+        CalcResult result;
+        bool finished;
+        {
+            CALCULATOR_STATS_STAGE(Pratt);
+            PrattParser parser(expression, m_functions, m_cancelFlag);
+            finished = parser.run(result);
+            // A fallback is counted once, by the pipeline below
+            if (finished) {
+                CALCULATOR_STATS_CALCULATION(parser.tokenCount());
+            }
+        }
+        // Nesting too deep for recursion falls through to the heap-backed pipeline below
+        if (finished) {
+            if (!result.ok()) {
+                CALCULATOR_STATS_ERROR(result.error);
+            }
+            return result;
+        }
+    }
 
-std::vector<CalculatorCore::Token> CalculatorCore::tokenize(const std::string& expression) const {
+    CalcResult result = tokenize(expression, m_tokens);
+    CALCULATOR_STATS_CALCULATION(m_tokens.size());
+    if (result.ok()) {
+        result = shuntingYard(m_tokens, m_rpn, m_operators);
+    }
+    if (result.ok()) {
+        result = evaluatePostfix(m_rpn, m_values);
+    }
+    if (!result.ok()) {
+        CALCULATOR_STATS_ERROR(result.error);
+    }
+    if (scratchBytes() > m_scratchLimit) {
+        releaseScratch();
+    }
+    return result;
+}
+
+size_t CalculatorCore::scratchBytes() const {
+    return (m_tokens.capacity() + m_rpn.capacity() + m_operators.capacity()) * sizeof(Token) +
+           m_values.capacity() * sizeof(double);
+}
+
+void CalculatorCore::releaseScratch() {
+    std::vector<Token>().swap(m_tokens);
+    std::vector<Token>().swap(m_rpn);
+    std::vector<Token>().swap(m_operators);
+    std::vector<double>().swap(m_values);
+}
+
+CompiledExpression CalculatorCore::compile(std::string_view expression, const CompileOptions& options) const {
     std::vector<Token> tokens;
+    std::vector<Token> rpn;
+    std::vector<Token> ops;
+    CalcResult result = tokenize(expression, tokens);
+    if (result.ok()) {
+        result = shuntingYard(tokens, rpn, ops);
+    }
+    if (!result.ok()) {
+        CALCULATOR_STATS_ERROR(result.error);
+        throw std::runtime_error(formatError(result, expression));
+    }
+
+    // tokenize has already validated operand/operator order, so the RPN is well formed
+    using Opcode = CompiledExpression::Opcode;
+    CompiledExpression compiled;
+    compiled.m_code.reserve(rpn.size() + 1);
+    compiled.m_positions.reserve(rpn.size() + 1);
+
+    for (const auto& token : rpn) {
+        uint32_t instruction = 0;
+        switch (token.type) {
+        case Token::Number:
+            instruction = CompiledExpression::encode(Opcode::Constant, static_cast<uint32_t>(compiled.m_constants.size()));
+            compiled.m_constants.push_back(token.number);
+            break;
+        case Token::Variable: {
+            auto slot = compiled.variableIndex(token.name);
+            if (!slot) {
+                slot = compiled.m_variables.size();
+                compiled.m_variables.emplace_back(token.name);
+            }
+            instruction = CompiledExpression::encode(Opcode::Variable, static_cast<uint32_t>(*slot));
+            break;
+        }
+        case Token::Function: {
+            const FunctionTable::Function& function = m_functions[token.function];
+            if (auto opcode = CompiledExpression::intrinsicOpcode(function.name)) {
+                instruction = CompiledExpression::encode(*opcode);
+                break;
+            }
+            auto callee = std::find_if(compiled.m_functions.begin(), compiled.m_functions.end(),
+                                       [&](const CompiledExpression::Function& f) {
+                                           return f.call == function.call && f.arity == function.arity;
+                                       });
+            if (callee == compiled.m_functions.end()) {
+                callee = compiled.m_functions.insert(callee, {function.call, function.arity});
+            }
+            instruction = CompiledExpression::encode(
+                Opcode::Call, static_cast<uint32_t>(callee - compiled.m_functions.begin()));
+            break;
+        }
+        case Token::UnaryOperator:
+            instruction = CompiledExpression::encode(Opcode::Negate);
+            break;
+        case Token::Operator:
+            instruction = CompiledExpression::encode(CompiledExpression::binaryOpcode(token.symbol));
+            break;
+        case Token::Parenthesis:
+        case Token::Separator:
+            continue;
+        }
+        compiled.m_code.push_back(instruction);
+        compiled.m_positions.push_back(token.position);
+    }
+    if (compiled.m_constants.size() > CompiledExpression::kMaxOperand ||
+        compiled.m_variables.size() > CompiledExpression::kMaxOperand ||
+        compiled.m_functions.size() > CompiledExpression::kMaxOperand) {
+        throw std::runtime_error("Expression too large to compile");
+    }
+
+    if (options.optimize) {
+        ExpressionOptimizer(options).run(compiled);
+    }
+    compiled.finalize();
+
+    return compiled;
+}
+
+bool CalculatorCore::isOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '/' || c == '^'; }
+
+bool CalculatorCore::isIdentifierStart(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+
+CalcResult CalculatorCore::tokenize(std::string_view expression, std::vector<Token>& tokens) const {
+    CALCULATOR_STATS_STAGE(Tokenize);
+    tokens.clear();
+
+    // Track whether the grammar expects an operand next, so misplaced tokens are reported where they occur
+    bool expectOperand = true;
     for (size_t i = 0; i < expression.size();) {
         if (isspace(expression[i])) {
             i++;
             continue;
         }
 
-        if (isdigit(expression[i]) || expression[i] == '.') {
-            std::string numStr;
-            while (i < expression.size() && (isdigit(expression[i]) || expression[i] == '.')) {
-                numStr += expression[i++];
+        auto position = static_cast<uint32_t>(i);
+        if (cancelRequested(m_cancelFlag, tokens.size())) {
+            return CalcResult::failure(CalcError::Cancelled, position);
+        }
+        Token token{Token::Number};
+        token.position = position;
+
+        if (isdigit(expression[i]) || expression[i] == '.' || isIdentifierStart(expression[i])) {
+            if (!expectOperand) {
+                return CalcResult::failure(CalcError::TooManyOperands, position);
+            }
+            if (isIdentifierStart(expression[i])) {
+                while (i < expression.size() && (isIdentifierStart(expression[i]) || isdigit(expression[i]))) {
+                    i++;
+                }
+                token.name = expression.substr(position, i - position);
+                if (i < expression.size() && expression[i] == '(') {
+                    // A call: the name is resolved here, and the '(' that follows still expects an operand
+                    std::optional<uint16_t> id = m_functions.find(token.name);
+                    if (!id) {
+                        return CalcResult::failure(CalcError::UnknownFunction, position);
+                    }
+                    token.type = Token::Function;
+                    token.function = *id;
+                    tokens.push_back(token);
+                    continue;
+                }
+                token.type = Token::Variable;
+            } else {
+                while (i < expression.size() && (isdigit(expression[i]) || expression[i] == '.')) {
+                    i++;
+                }
+                // from_chars is locale-independent and parses in place without building a string
+                auto [end, ec] = std::from_chars(expression.data() + position, expression.data() + i, token.number);
+                if (ec != std::errc() || end != expression.data() + i) {
+                    return CalcResult::failure(CalcError::InvalidNumber, position);
+                }
             }
-            tokens.push_back({Token::Number, numStr});
-        } else if (expression[i] == '(' || expression[i] == ')') {
-            tokens.push_back({Token::Parenthesis, std::string(1, expression[i++])});
+            expectOperand = false;
+        } else if (expression[i] == '(') {
+            if (!expectOperand) {
+                return CalcResult::failure(CalcError::TooManyOperands, position);
+            }
+            token.type = Token::Parenthesis;
+            token.symbol = expression[i++];
+        } else if (expression[i] == ')') {
+            if (expectOperand) {
+                return CalcResult::failure(CalcError::NotEnoughOperands, position);
+            }
+            token.type = Token::Parenthesis;
+            token.symbol = expression[i++];
+        } else if (expression[i] == ',') {
+            if (expectOperand) {
+                return CalcResult::failure(CalcError::NotEnoughOperands, position);
+            }
+            token.type = Token::Separator;
+            token.symbol = expression[i++];
+            expectOperand = true;
         } else if (isOperator(expression[i])) {
-            tokens.push_back({Token::Operator, std::string(1, expression[i++])});
+            // An operator is unary when no operand precedes it
+            char op = expression[i++];
+            if (!expectOperand) {
+                token.type = Token::Operator;
+                token.symbol = op;
+                expectOperand = true;
+            } else if (op == '-') {
+                token.type = Token::UnaryOperator;
+                token.symbol = '~';
+            } else if (op == '+') {
+                continue;
+            } else {
+                return CalcResult::failure(CalcError::NotEnoughOperands, position);
+            }
         } else {
-            throw std::runtime_error("Invalid character in expression: " + std::string(1, expression[i]));
+            return CalcResult::failure(CalcError::InvalidCharacter, position);
         }
+        tokens.push_back(token);
     }
-    return tokens;
+
+    if (tokens.empty()) {
+        return CalcResult::failure(CalcError::EmptyExpression, 0);
+    }
+    if (expectOperand) {
+        return CalcResult::failure(CalcError::NotEnoughOperands, static_cast<uint32_t>(expression.size()));
+    }
+    return {};
 }
 
-std::vector<CalculatorCore::Token> CalculatorCore::shuntingYard(const std::vector<Token>& tokens) const {
-    std::vector<Token> output;
-    std::stack<Token> ops;
+CalcResult CalculatorCore::shuntingYard(const std::vector<Token>& tokens, std::vector<Token>& output,
+                                        std::vector<Token>& ops) const {
+    CALCULATOR_STATS_STAGE(ShuntingYard);
+    // Neither buffer can outgrow the token count, so reserving once keeps reused scratch allocation-free
+    output.clear();
+    ops.clear();
+    output.reserve(tokens.size());
+    ops.reserve(tokens.size());
 
     for (const auto& token : tokens) {
+        if (cancelRequested(m_cancelFlag, &token - tokens.data())) {
+            return CalcResult::failure(CalcError::Cancelled, token.position);
+        }
         switch (token.type) {
         case Token::Number:
+        case Token::Variable:
             output.push_back(token);
             break;
 
+        case Token::Function:
+        case Token::UnaryOperator:
+            // Prefix operators have no left operand, so nothing on the stack can be reduced yet; a function
+            // stays beneath its '(' until the matching ')'
+            ops.push_back(token);
+            CALCULATOR_STATS_OPERATOR_DEPTH(ops.size());
+            break;
+
         case Token::Parenthesis:
-            if (token.value == "(") {
-                ops.push(token);
+            if (token.symbol == '(') {
+                ops.push_back(token);
+                CALCULATOR_STATS_OPERATOR_DEPTH(ops.size());
             } else {
-                while (!ops.empty() && ops.top().value != "(") {
-                    output.push_back(ops.top());
-                    ops.pop();
+                while (!ops.empty() && ops.back().symbol != '(') {
+                    output.push_back(ops.back());
+                    ops.pop_back();
                 }
                 if (ops.empty()) {
-                    throw std::runtime_error("Mismatched parentheses");
+                    return CalcResult::failure(CalcError::MismatchedParentheses, token.position);
                 }
-                ops.pop(); // Remove '('
+                uint16_t separators = ops.back().function;
+                ops.pop_back(); // Remove '('
+                if (!ops.empty() && ops.back().type == Token::Function) {
+                    if (separators + 1u != m_functions[ops.back().function].arity) {
+                        return CalcResult::failure(CalcError::WrongArgumentCount, token.position);
+                    }
+                    output.push_back(ops.back());
+                    ops.pop_back();
+                }
+            }
+            break;
+
+        case Token::Separator: {
+            while (!ops.empty() && ops.back().symbol != '(') {
+                output.push_back(ops.back());
+                ops.pop_back();
+            }
+            // Only a call's parentheses may hold separators, and one fewer than the function's arity
+            if (ops.size() < 2 || ops[ops.size() - 2].type != Token::Function ||
+                ops.back().function + 1u >= m_functions[ops[ops.size() - 2].function].arity) {
+                return CalcResult::failure(CalcError::WrongArgumentCount, token.position);
             }
+            ops.back().function++;
             break;
+        }
 
         case Token::Operator:
-            while (!ops.empty() && ops.top().type == Token::Operator &&
-                   getPrecedence(ops.top().value[0]) >= getPrecedence(token.value[0])) {
-                output.push_back(ops.top());
-                ops.pop();
+            // A right-associative operator leaves an equal-precedence operator on the stack to bind later
+            while (!ops.empty() && ops.back().type != Token::Parenthesis &&
+                   (getPrecedence(ops.back().symbol) > getPrecedence(token.symbol) ||
+                    (getPrecedence(ops.back().symbol) == getPrecedence(token.symbol) &&
+                     !isRightAssociative(token.symbol)))) {
+                output.push_back(ops.back());
+                ops.pop_back();
             }
-            ops.push(token);
+            ops.push_back(token);
+            CALCULATOR_STATS_OPERATOR_DEPTH(ops.size());
             break;
         }
     }
 
     while (!ops.empty()) {
-        if (ops.top().value == "(") {
-            throw std::runtime_error("Mismatched parentheses");
+        if (ops.back().symbol == '(') {
+            return CalcResult::failure(CalcError::MismatchedParentheses, ops.back().position);
         }
-        output.push_back(ops.top());
-        ops.pop();
+        output.push_back(ops.back());
+        ops.pop_back();
     }
-
-    return output;
+    return {};
 }
 
-double CalculatorCore::evaluatePostfix(const std::vector<Token>& rpn) const {
-    std::stack<double> values;
+CalcResult CalculatorCore::evaluatePostfix(const std::vector<Token>& rpn, std::vector<double>& values) const {
+    CALCULATOR_STATS_STAGE(Evaluate);
+    values.clear();
+    values.reserve(rpn.size());
 
     for (const auto& token : rpn) {
+        if (cancelRequested(m_cancelFlag, &token - rpn.data())) {
+            return CalcResult::failure(CalcError::Cancelled, token.position);
+        }
         if (token.type == Token::Number) {
-            values.push(std::stod(token.value));
+            values.push_back(token.number);
+        } else if (token.type == Token::Variable) {
+            return CalcResult::failure(CalcError::UnboundVariable, token.position);
+        } else if (token.type == Token::UnaryOperator) {
+            if (values.empty()) {
+                return CalcResult::failure(CalcError::NotEnoughOperands, token.position);
+            }
+            values.back() = -values.back();
+        } else if (token.type == Token::Function) {
+            const FunctionTable::Function& function = m_functions[token.function];
+            if (values.size() < function.arity) {
+                return CalcResult::failure(CalcError::NotEnoughOperands, token.position);
+            }
+            // The arguments are the top arity values, already in source order
+            double result = function.call(values.data() + values.size() - function.arity);
+            values.resize(values.size() - function.arity + 1);
+            values.back() = result;
         } else {
             if (values.size() < 2) {
-                throw std::runtime_error("Invalid expression: not enough operands");
+                return CalcResult::failure(CalcError::NotEnoughOperands, token.position);
+            }
+            double b = values.back();
+            values.pop_back();
+            CalcResult result = applyOperation(token.symbol, values.back(), b);
+            if (!result.ok()) {
+                result.position = token.position;
+                return result;
             }
-            double b = values.top();
-            values.pop();
-            double a = values.top();
-            values.pop();
-            values.push(applyOperation(token.value[0], a, b));
+            values.back() = result.value;
         }
     }
 
     if (values.size() != 1) {
-        throw std::runtime_error("Invalid expression: too many operands");
+        return CalcResult::failure(values.empty() ? CalcError::EmptyExpression : CalcError::TooManyOperands, 0);
     }
 
-    return values.top();
+    return CalcResult::success(values.back());
 }
 
-int CalculatorCore::getPrecedence(char op) const {
-    switch (op) {
-    case '^':
-        return 4;
-    case '*':
-    case '/':
-        return 3;
-    case '+':
-    case '-':
-        return 2;
-    default:
-        return 0;
-    }
-}
+int CalculatorCore::getPrecedence(char op) { return operatorPrecedence(op); }
 
-double CalculatorCore::applyOperation(char op, double a, double b) const {
+bool CalculatorCore::isRightAssociative(char op) { return operatorIsRightAssociative(op); }
+
+CalcResult CalculatorCore::applyOperation(char op, double a, double b) {
     switch (op) {
     case '+':
-        return a + b;
+        return CalcResult::success(a + b);
     case '-':
-        return a - b;
+        return CalcResult::success(a - b);
     case '*':
-        return a * b;
+        return CalcResult::success(a * b);
     case '/':
-        if (b == 0)
-            throw std::runtime_error("Division by zero");
-        return a / b;
+        if (b == 0) {
+            return CalcResult::failure(CalcError::DivisionByZero, 0);
+        }
+        return CalcResult::success(a / b);
     case '^':
-        return std::pow(a, b);
+        return CalcResult::success(power_kernels::pow(a, b));
     default:
-        throw std::runtime_error("Unknown operator: " + std::string(1, op));
+        return CalcResult::failure(CalcError::UnknownOperator, 0);
     }
 }
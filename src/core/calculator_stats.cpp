@@ -0,0 +1,124 @@
+#include "calculator/calculator_stats.hpp"
+
+#include "stats_recorder.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace calculator_stats {
+namespace {
+/**
+ * @brief Tracks every thread's counters and keeps the totals of threads that have exited
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<detail::ThreadCounters*> live;
+    Snapshot retired;
+};
+
+Registry& registry() {
+    // Leaked on purpose: threads may exit during static destruction and still need to unregister
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+uint64_t read(const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); }
+
+void accumulate(Snapshot& total, const detail::ThreadCounters& counters) {
+    for (size_t stage = 0; stage < total.stages.size(); stage++) {
+        Histogram& histogram = total.stages[stage];
+        for (size_t bucket = 0; bucket < Histogram::kBuckets; bucket++) {
+            histogram.buckets[bucket] += read(counters.buckets[stage][bucket]);
+        }
+        histogram.count += read(counters.stageCount[stage]);
+        histogram.totalNanoseconds += read(counters.stageNanoseconds[stage]);
+    }
+    for (size_t kind = 0; kind < total.errors.size(); kind++) {
+        total.errors[kind] += read(counters.errors[kind]);
+    }
+    total.calculations += read(counters.calculations);
+    total.tokens += read(counters.tokens);
+    total.maxOperatorStackDepth = std::max(total.maxOperatorStackDepth, read(counters.maxOperatorStackDepth));
+}
+
+/**
+ * @brief Owns one thread's counters and folds them into the retired totals when the thread exits
+ */
+struct ThreadRegistration {
+    std::unique_ptr<detail::ThreadCounters> counters = std::make_unique<detail::ThreadCounters>();
+
+    ThreadRegistration() {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().live.push_back(counters.get());
+    }
+
+    ~ThreadRegistration() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        accumulate(reg.retired, *counters);
+        reg.live.erase(std::find(reg.live.begin(), reg.live.end(), counters.get()));
+    }
+};
+} // namespace
+
+namespace detail {
+ThreadCounters& local() {
+    thread_local ThreadRegistration registration;
+    return *registration.counters;
+}
+} // namespace detail
+
+uint64_t Histogram::percentileNanoseconds(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+        seen += buckets[bucket];
+        if (seen > target || seen == count) {
+            return bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+        }
+    }
+    return (uint64_t{1} << (kBuckets - 1)) - 1;
+}
+
+Snapshot snapshot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    Snapshot total = reg.retired;
+    for (const auto* counters : reg.live) {
+        accumulate(total, *counters);
+    }
+    return total;
+}
+
+void reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.retired = Snapshot{};
+    for (auto* counters : reg.live) {
+        // Racy against a concurrently recording thread, which may lose an increment; acceptable for a reset
+        for (auto& stage : counters->buckets) {
+            for (auto& bucket : stage) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+        for (auto& counter : counters->stageCount) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto& counter : counters->stageNanoseconds) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto& counter : counters->errors) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        counters->calculations.store(0, std::memory_order_relaxed);
+        counters->tokens.store(0, std::memory_order_relaxed);
+        counters->maxOperatorStackDepth.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace calculator_stats
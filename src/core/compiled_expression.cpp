@@ -0,0 +1,266 @@
+#include "calculator/compiled_expression.hpp"
+
+#include "calculator/power_kernels.hpp"
+#include "builtin_math.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+double CompiledExpression::evaluate(const std::vector<double>& values) const {
+    if (values.size() < m_variables.size()) {
+        throw std::runtime_error("Unbound variable: " + m_variables[values.size()]);
+    }
+    CalcResult result = tryEvaluate(values);
+    if (!result.ok()) {
+        throw std::runtime_error(errorName(result.error));
+    }
+    return result.value;
+}
+
+CalcResult CompiledExpression::tryEvaluate(const std::vector<double>& values) const {
+    if (values.size() < m_variables.size()) {
+        return CalcResult::failure(CalcError::UnboundVariable, 0);
+    }
+    if (m_code.empty()) {
+        return CalcResult::failure(CalcError::EmptyExpression, 0);
+    }
+
+    double local[kLocalStackSize];
+    if (m_maxStackDepth <= kLocalStackSize) {
+        return execute(values.data(), local);
+    }
+    std::unique_ptr<double[]> spilled(new double[m_maxStackDepth]);
+    return execute(values.data(), spilled.get());
+}
+
+// Labels as values are a GNU extension; define CALCULATOR_NO_COMPUTED_GOTO to force the portable switch loop
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(CALCULATOR_NO_COMPUTED_GOTO)
+#define CALCULATOR_THREADED_DISPATCH 1
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+CalcResult CompiledExpression::execute(const double* variables, double* stack) const {
+    const uint32_t* pc = m_code.data();
+    const double* constants = m_constants.data();
+    const Function* functions = m_functions.data();
+    // The top of the stack is cached in a register; sp is one past the values beneath it. The first push
+    // spills the uninitialized cache into stack[0], so the stack needs m_maxStackDepth slots, not one fewer.
+    double top = 0.0;
+    double* sp = stack;
+
+    // Each handler ends by jumping straight to the next one, giving the branch predictor one indirect
+    // branch per opcode instead of a single shared switch
+#if defined(CALCULATOR_THREADED_DISPATCH)
+    static const void* const kDispatch[] = {&&op_Constant, &&op_Variable, &&op_Dup,      &&op_Negate,
+                                            &&op_Add,      &&op_Subtract, &&op_Multiply, &&op_Divide,
+                                            &&op_Power,    &&op_Min,      &&op_Max,      &&op_Abs,
+                                            &&op_Sqrt,     &&op_Call,     &&op_Return};
+#define VM_CASE(opcode) op_##opcode
+#define VM_NEXT() goto* kDispatch[*pc & 0xff]
+    VM_NEXT();
+#else
+#define VM_CASE(opcode) case Opcode::opcode
+#define VM_NEXT() continue
+    for (;;) {
+        switch (opcodeOf(*pc)) {
+#endif
+
+    VM_CASE(Constant) : {
+        *sp++ = top;
+        top = constants[operandOf(*pc++)];
+        VM_NEXT();
+    }
+    VM_CASE(Variable) : {
+        *sp++ = top;
+        top = variables[operandOf(*pc++)];
+        VM_NEXT();
+    }
+    VM_CASE(Dup) : {
+        *sp++ = top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Negate) : {
+        top = -top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Add) : {
+        top = *--sp + top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Subtract) : {
+        top = *--sp - top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Multiply) : {
+        top = *--sp * top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Divide) : {
+        if (top == 0) {
+            return CalcResult::failure(CalcError::DivisionByZero, m_positions[pc - m_code.data()]);
+        }
+        top = *--sp / top;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Power) : {
+        top = power_kernels::pow(*--sp, top);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Min) : {
+        top = builtin_math::min(*--sp, top);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Max) : {
+        top = builtin_math::max(*--sp, top);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Abs) : {
+        top = std::fabs(top);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Sqrt) : {
+        top = std::sqrt(top);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(Call) : {
+        // Spill the cached top so the arguments lie contiguously in source order, ending at sp
+        const Function& function = functions[operandOf(*pc++)];
+        *sp = top;
+        sp -= function.arity - 1;
+        top = function.call(sp);
+        VM_NEXT();
+    }
+    VM_CASE(Return) : {
+        return CalcResult::success(top);
+    }
+
+#if !defined(CALCULATOR_THREADED_DISPATCH)
+        }
+    }
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+#if defined(CALCULATOR_THREADED_DISPATCH)
+#pragma GCC diagnostic pop
+#endif
+
+double CompiledExpression::evaluate(const std::unordered_map<std::string, double>& bindings) const {
+    std::vector<double> values;
+    values.reserve(m_variables.size());
+    for (const auto& name : m_variables) {
+        auto it = bindings.find(name);
+        if (it == bindings.end()) {
+            throw std::runtime_error("Unbound variable: " + name);
+        }
+        values.push_back(it->second);
+    }
+    return evaluate(values);
+}
+
+void CompiledExpression::finalize() {
+    m_code.push_back(encode(Opcode::Return));
+    m_positions.push_back(m_positions.empty() ? 0 : m_positions.back());
+
+    size_t depth = 0;
+    m_maxStackDepth = 0;
+    for (uint32_t instruction : m_code) {
+        switch (opcodeOf(instruction)) {
+        case Opcode::Constant:
+        case Opcode::Variable:
+        case Opcode::Dup:
+            m_maxStackDepth = std::max(m_maxStackDepth, ++depth);
+            break;
+        case Opcode::Negate:
+        case Opcode::Abs:
+        case Opcode::Sqrt:
+        case Opcode::Return:
+            break;
+        case Opcode::Call:
+            // The spilled top needs one slot past the current depth
+            m_maxStackDepth = std::max(m_maxStackDepth, depth + 1);
+            depth -= m_functions[operandOf(instruction)].arity - 1;
+            break;
+        default:
+            depth--;
+            break;
+        }
+    }
+}
+
+CompiledExpression::Opcode CompiledExpression::binaryOpcode(char op) {
+    switch (op) {
+    case '+':
+        return Opcode::Add;
+    case '-':
+        return Opcode::Subtract;
+    case '*':
+        return Opcode::Multiply;
+    case '/':
+        return Opcode::Divide;
+    default:
+        return Opcode::Power;
+    }
+}
+
+std::optional<CompiledExpression::Opcode> CompiledExpression::intrinsicOpcode(std::string_view function) {
+    if (function == "min") {
+        return Opcode::Min;
+    }
+    if (function == "max") {
+        return Opcode::Max;
+    }
+    if (function == "abs") {
+        return Opcode::Abs;
+    }
+    if (function == "sqrt") {
+        return Opcode::Sqrt;
+    }
+    return std::nullopt;
+}
+
+CompiledExpression::Function CompiledExpression::intrinsicFunction(Opcode opcode) {
+    const char* name = "sqrt";
+    switch (opcode) {
+    case Opcode::Min:
+        name = "min";
+        break;
+    case Opcode::Max:
+        name = "max";
+        break;
+    case Opcode::Abs:
+        name = "abs";
+        break;
+    default:
+        break;
+    }
+    const FunctionTable& builtins = FunctionTable::builtins();
+    const FunctionTable::Function& function = builtins[*builtins.find(name)];
+    return {function.call, function.arity};
+}
+
+std::optional<size_t> CompiledExpression::variableIndex(std::string_view name) const {
+    for (size_t i = 0; i < m_variables.size(); i++) {
+        if (m_variables[i] == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,95 @@
+#include "calculator/eval_protocol.hpp"
+
+#include <cstring>
+
+namespace eval_protocol {
+
+namespace {
+// Byte-by-byte so the format is little-endian whatever the host is
+void putU32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+uint32_t getU32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+uint64_t getU64(const char* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+} // namespace
+
+void appendRequest(std::string& out, uint32_t id, std::string_view expression) {
+    putU32(out, static_cast<uint32_t>(4 + expression.size()));
+    putU32(out, id);
+    out.append(expression);
+}
+
+void appendResponse(std::string& out, uint32_t id, const CalcResult& result) {
+    uint64_t bits;
+    std::memcpy(&bits, &result.value, sizeof(bits));
+    putU32(out, static_cast<uint32_t>(kResponsePayload));
+    putU32(out, id);
+    out.push_back(static_cast<char>(result.error));
+    putU32(out, result.position);
+    putU64(out, bits);
+}
+
+ParseStatus parseRequest(const char* data, size_t size, Request& request, size_t& consumed) {
+    if (size < kLengthBytes) {
+        return ParseStatus::Incomplete;
+    }
+    uint32_t payload = getU32(data);
+    if (payload < 4 || payload > kMaxRequestPayload) {
+        return ParseStatus::Invalid;
+    }
+    if (size - kLengthBytes < payload) {
+        return ParseStatus::Incomplete;
+    }
+    request.id = getU32(data + kLengthBytes);
+    request.expression = std::string_view(data + kLengthBytes + 4, payload - 4);
+    consumed = kLengthBytes + payload;
+    return ParseStatus::Complete;
+}
+
+ParseStatus parseResponse(const char* data, size_t size, Response& response, size_t& consumed) {
+    if (size < kLengthBytes) {
+        return ParseStatus::Incomplete;
+    }
+    if (getU32(data) != kResponsePayload) {
+        return ParseStatus::Invalid;
+    }
+    if (size - kLengthBytes < kResponsePayload) {
+        return ParseStatus::Incomplete;
+    }
+    const char* payload = data + kLengthBytes;
+    uint8_t error = static_cast<uint8_t>(payload[4]);
+    if (error >= static_cast<uint8_t>(CalcError::Count)) {
+        return ParseStatus::Invalid;
+    }
+    uint64_t bits = getU64(payload + 9);
+    response.id = getU32(payload);
+    response.result.error = static_cast<CalcError>(error);
+    response.result.position = getU32(payload + 5);
+    std::memcpy(&response.result.value, &bits, sizeof(bits));
+    consumed = kLengthBytes + kResponsePayload;
+    return ParseStatus::Complete;
+}
+
+} // namespace eval_protocol
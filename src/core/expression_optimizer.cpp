@@ -0,0 +1,183 @@
+#include "expression_optimizer.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+char ExpressionOptimizer::symbolOf(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::Add:
+        return '+';
+    case Opcode::Subtract:
+        return '-';
+    case Opcode::Multiply:
+        return '*';
+    case Opcode::Divide:
+        return '/';
+    default:
+        return '^';
+    }
+}
+
+void ExpressionOptimizer::run(CompiledExpression& expression) {
+    m_out.clear();
+    m_stack.clear();
+    m_out.reserve(expression.m_code.size());
+
+    for (size_t i = 0; i < expression.m_code.size(); i++) {
+        uint32_t word = expression.m_code[i];
+        Instruction instruction{CompiledExpression::opcodeOf(word)};
+        instruction.position = expression.m_positions[i];
+
+        switch (instruction.opcode) {
+        case Opcode::Constant:
+            instruction.value = expression.m_constants[CompiledExpression::operandOf(word)];
+            m_stack.push_back({m_out.size(), true, instruction.value});
+            m_out.push_back(instruction);
+            break;
+        case Opcode::Variable:
+            instruction.operand = CompiledExpression::operandOf(word);
+            m_stack.push_back({m_out.size(), false, 0.0});
+            m_out.push_back(instruction);
+            break;
+        case Opcode::Negate:
+            negate(instruction);
+            break;
+        case Opcode::Call:
+            instruction.operand = CompiledExpression::operandOf(word);
+            call(instruction, expression.m_functions[instruction.operand]);
+            break;
+        case Opcode::Min:
+        case Opcode::Max:
+        case Opcode::Abs:
+        case Opcode::Sqrt:
+            call(instruction, CompiledExpression::intrinsicFunction(instruction.opcode));
+            break;
+        default:
+            binary(instruction);
+            break;
+        }
+    }
+
+    expression.m_opsSaved = expression.m_code.size() - m_out.size();
+    expression.m_code.clear();
+    expression.m_constants.clear();
+    expression.m_positions.clear();
+    for (const auto& instruction : m_out) {
+        uint32_t operand = instruction.operand;
+        if (instruction.opcode == Opcode::Constant) {
+            operand = static_cast<uint32_t>(expression.m_constants.size());
+            expression.m_constants.push_back(instruction.value);
+        }
+        expression.m_code.push_back(CompiledExpression::encode(instruction.opcode, operand));
+        expression.m_positions.push_back(instruction.position);
+    }
+}
+
+void ExpressionOptimizer::negate(const Instruction& instruction) {
+    Fragment& operand = m_stack.back();
+    if (operand.constant) {
+        // A constant fragment is always a single Constant instruction
+        operand.value = -operand.value;
+        m_out.back().value = operand.value;
+    } else if (m_out.back().opcode == Opcode::Negate) {
+        m_out.pop_back(); // --x
+    } else {
+        m_out.push_back(instruction);
+    }
+}
+
+void ExpressionOptimizer::binary(const Instruction& instruction) {
+    Fragment right = m_stack.back();
+    m_stack.pop_back();
+    Fragment& left = m_stack.back();
+
+    if (left.constant && right.constant) {
+        CalcResult result = CalculatorCore::applyOperation(symbolOf(instruction.opcode), left.value, right.value);
+        if (result.ok()) {
+            m_out.resize(left.begin);
+            Instruction folded{Opcode::Constant};
+            folded.value = result.value;
+            folded.position = instruction.position;
+            m_out.push_back(folded);
+            left.value = result.value;
+            return;
+        }
+        // Leave the failing operation in place so evaluation reports it
+        m_out.push_back(instruction);
+        left.constant = false;
+        return;
+    }
+
+    bool dropRight = false;
+    bool dropLeft = false;
+    switch (instruction.opcode) {
+    case Opcode::Add:
+        dropRight = isConstant(right, 0.0);
+        dropLeft = isConstant(left, 0.0);
+        break;
+    case Opcode::Subtract:
+        dropRight = isConstant(right, 0.0);
+        break;
+    case Opcode::Multiply:
+        dropRight = isConstant(right, 1.0);
+        dropLeft = isConstant(left, 1.0);
+        break;
+    case Opcode::Divide:
+        dropRight = isConstant(right, 1.0);
+        if (!dropRight && right.constant && m_options.fastMath && std::isnormal(1.0 / right.value)) {
+            m_out.back().value = 1.0 / right.value;
+            m_out.push_back({Opcode::Multiply, 0, 0.0, instruction.position});
+            left.constant = false;
+            return;
+        }
+        break;
+    case Opcode::Power:
+        dropRight = isConstant(right, 1.0);
+        if (isConstant(right, 2.0)) {
+            // pow(x, 2) is x*x correctly rounded, which is exactly what the multiply produces
+            m_out.back() = {Opcode::Dup, 0, 0.0, m_out.back().position};
+            m_out.push_back({Opcode::Multiply, 0, 0.0, instruction.position});
+            left.constant = false;
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (dropRight) {
+        m_out.resize(right.begin);
+    } else if (dropLeft) {
+        m_out.erase(m_out.begin() + static_cast<std::ptrdiff_t>(left.begin));
+        left = right;
+        left.begin--;
+    } else {
+        m_out.push_back(instruction);
+        left.constant = false;
+    }
+}
+
+void ExpressionOptimizer::call(const Instruction& instruction, const CompiledExpression::Function& function) {
+    // The arguments are the top arity fragments, so the call's fragment starts where the first one does
+    size_t first = m_stack.size() - function.arity;
+    Fragment result{m_stack[first].begin, false, 0.0};
+    if (std::all_of(m_stack.begin() + first, m_stack.end(), [](const Fragment& f) { return f.constant; })) {
+        double arguments[FunctionTable::kMaxArity];
+        for (size_t i = 0; i < function.arity; i++) {
+            arguments[i] = m_stack[first + i].value;
+        }
+        Instruction folded{Opcode::Constant};
+        folded.value = function.call(arguments);
+        folded.position = instruction.position;
+        m_out.resize(result.begin);
+        m_out.push_back(folded);
+        result.constant = true;
+        result.value = folded.value;
+    } else {
+        m_out.push_back(instruction);
+    }
+    m_stack.resize(first);
+    m_stack.push_back(result);
+}
@@ -0,0 +1,70 @@
+#ifndef CALCULATOR_EXPRESSION_OPTIMIZER_H
+#define CALCULATOR_EXPRESSION_OPTIMIZER_H
+
+#include "calculator/compiled_expression.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ExpressionOptimizer
+ * @brief Peephole pass over a compiled RPN program: constant folding, including calls, and algebraic identities
+ *
+ * The program is replayed against a stack that records, for every value, where its instructions start
+ * and whether it is a known constant. A fold that would fail (division by a constant zero) is left in
+ * the program, and no rewrite drops a non-constant subexpression, so every error reachable in the
+ * original program is still raised, at the same position.
+ */
+class ExpressionOptimizer {
+public:
+    explicit ExpressionOptimizer(const CompileOptions& options) : m_options(options) {}
+
+    /**
+     * @brief Rewrite the program in place and record the number of removed instructions
+     * @param expression A program that has not been finalized yet (no trailing Return)
+     */
+    void run(CompiledExpression& expression);
+
+private:
+    using Opcode = CompiledExpression::Opcode;
+
+    struct Instruction {
+        Opcode opcode;
+        uint32_t operand = 0; // Variable slot or callee index
+        double value = 0.0;   // Constant value
+        uint32_t position = 0;
+    };
+
+    /**
+     * @brief The instructions from begin to the next fragment compute one stack value
+     */
+    struct Fragment {
+        size_t begin;
+        bool constant;
+        double value;
+    };
+
+    CompileOptions m_options;
+    std::vector<Instruction> m_out;
+    std::vector<Fragment> m_stack;
+
+    void negate(const Instruction& instruction);
+    void binary(const Instruction& instruction);
+
+    /**
+     * @brief Fold a call whose arguments are all constant; functions are required to be pure
+     */
+    void call(const Instruction& instruction, const CompiledExpression::Function& function);
+
+    /**
+     * @brief Operator character of a binary opcode, for CalculatorCore::applyOperation
+     */
+    static char symbolOf(Opcode opcode);
+
+    static bool isConstant(const Fragment& fragment, double value) {
+        return fragment.constant && fragment.value == value;
+    }
+};
+
+#endif // CALCULATOR_EXPRESSION_OPTIMIZER_H
@@ -0,0 +1,152 @@
+#include "calculator/function_sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+CompiledExpression checkedPlotExpression(CompiledExpression expression) {
+    if (expression.variables().size() > 1) {
+        throw std::runtime_error("Plot expressions may use only one variable");
+    }
+    return expression;
+}
+
+// Sample indices above this are no longer exact in a double
+constexpr double kMaxSampleIndex = 4503599627370496.0; // 2^52
+
+double chordDeviation(const FunctionSampler::Point& left, const FunctionSampler::Point& mid,
+                      const FunctionSampler::Point& right) {
+    return std::abs(mid.y - (left.y + right.y) / 2);
+}
+} // namespace
+
+FunctionSampler::FunctionSampler(CompiledExpression expression, size_t cacheTiles)
+    : m_evaluator(checkedPlotExpression(std::move(expression))), m_capacity(std::max<size_t>(1, cacheTiles)) {}
+
+void FunctionSampler::sample(double xMin, double xMax, size_t resolution, std::vector<Point>& points) {
+    points.clear();
+    if (!(xMax > xMin) || !std::isfinite(xMax - xMin) || resolution == 0) {
+        return;
+    }
+
+    // The largest power-of-two spacing that still gives @p resolution samples across the range
+    int level = std::ilogb((xMax - xMin) / static_cast<double>(resolution));
+    double tileWidth = std::ldexp(static_cast<double>(kTileSamples), level);
+    double first = std::floor(xMin / tileWidth);
+    double last = std::floor(xMax / tileWidth);
+    if (std::max(std::abs(first), std::abs(last)) * kTileSamples >= kMaxSampleIndex) {
+        return;
+    }
+
+    for (auto index = static_cast<int64_t>(first); index <= static_cast<int64_t>(last); index++) {
+        const Tile& current = tile({level, index});
+        auto end = current.points.end();
+        if (index != static_cast<int64_t>(last)) {
+            --end; // The next tile starts with the same sample
+        }
+        points.insert(points.end(), current.points.begin(), end);
+    }
+}
+
+const FunctionSampler::Tile& FunctionSampler::tile(TileKey key) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_stats.hits++;
+        m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+        return *it->second;
+    }
+    m_stats.misses++;
+
+    m_tiles.push_front(Tile{key, {}});
+    computeTile(m_tiles.front());
+    m_index.emplace(key, m_tiles.begin());
+    if (m_tiles.size() > m_capacity) {
+        m_index.erase(m_tiles.back().key);
+        m_tiles.pop_back();
+        m_stats.evictions++;
+    }
+    return m_tiles.front();
+}
+
+void FunctionSampler::computeTile(Tile& tile) {
+    // Base samples at exact multiples of the spacing, including the first sample of the next tile
+    const int64_t first = tile.key.index * static_cast<int64_t>(kTileSamples);
+    m_xs.resize(kTileSamples + 1);
+    for (size_t i = 0; i <= kTileSamples; i++) {
+        m_xs[i] = std::ldexp(static_cast<double>(first + static_cast<int64_t>(i)), tile.key.level);
+    }
+    evaluate(kTileSamples + 1);
+
+    std::vector<Point>& points = tile.points;
+    points.resize(kTileSamples + 1);
+    double low = std::numeric_limits<double>::infinity();
+    double high = -low;
+    for (size_t i = 0; i <= kTileSamples; i++) {
+        points[i] = {m_xs[i], m_ys[i]};
+        if (std::isfinite(m_ys[i])) {
+            low = std::min(low, m_ys[i]);
+            high = std::max(high, m_ys[i]);
+        }
+    }
+    const double tolerance = high > low ? (high - low) * kRefineTolerance : 0.0;
+
+    // Seed refinement from the base samples: a span bends if the second difference at either end predicts
+    // a midpoint deviation over the tolerance (it is eight times the deviation for a quadratic)
+    auto bends = [&](size_t i) {
+        if (i == 0 || i == kTileSamples) {
+            return false;
+        }
+        double y0 = points[i - 1].y, y1 = points[i].y, y2 = points[i + 1].y;
+        return std::isfinite(y0) && std::isfinite(y1) && std::isfinite(y2) &&
+               std::abs(y0 - 2 * y1 + y2) / 8 > tolerance;
+    };
+    m_spans.clear();
+    for (size_t i = 0; i < kTileSamples; i++) {
+        bool gapEdge = std::isnan(points[i].y) != std::isnan(points[i + 1].y);
+        if (gapEdge || bends(i) || bends(i + 1)) {
+            m_spans.push_back({points[i], points[i + 1]});
+        }
+    }
+
+    // Bisect every pending span in one batch per pass; a half keeps going while the curve still strays from
+    // the chord, or while it contains the edge of a gap
+    for (int depth = 0; depth < kMaxRefineDepth && !m_spans.empty(); depth++) {
+        m_xs.resize(m_spans.size());
+        for (size_t j = 0; j < m_spans.size(); j++) {
+            m_xs[j] = (m_spans[j].left.x + m_spans[j].right.x) / 2;
+        }
+        evaluate(m_spans.size());
+
+        m_nextSpans.clear();
+        for (size_t j = 0; j < m_spans.size(); j++) {
+            const Span& span = m_spans[j];
+            Point mid{m_xs[j], m_ys[j]};
+            points.push_back(mid);
+
+            bool curved = std::isfinite(span.left.y) && std::isfinite(mid.y) && std::isfinite(span.right.y) &&
+                          chordDeviation(span.left, mid, span.right) > tolerance;
+            for (const Span& half : {Span{span.left, mid}, Span{mid, span.right}}) {
+                if (curved || std::isnan(half.left.y) != std::isnan(half.right.y)) {
+                    m_nextSpans.push_back(half);
+                }
+            }
+        }
+        std::swap(m_spans, m_nextSpans);
+    }
+
+    // Base samples are already sorted; merge the refinements in
+    auto refined = points.begin() + kTileSamples + 1;
+    std::sort(refined, points.end(), [](const Point& a, const Point& b) { return a.x < b.x; });
+    std::inplace_merge(points.begin(), refined, points.end(), [](const Point& a, const Point& b) { return a.x < b.x; });
+    points.shrink_to_fit();
+}
+
+void FunctionSampler::evaluate(size_t count) {
+    const double* column = m_xs.data();
+    m_ys.resize(count);
+    m_evaluator.evaluate(&column, count, m_ys.data());
+    m_samplesEvaluated += count;
+}
@@ -0,0 +1,104 @@
+#include "calculator/function_table.hpp"
+
+#include "builtin_math.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+using Function = FunctionTable::Function;
+
+// Sorted by name, so lookup can bisect; a built-in's id is its index here
+constexpr Function kBuiltins[] = {
+    {"abs", [](const double* a) { return std::fabs(a[0]); }, 1},
+    {"acos", [](const double* a) { return std::acos(a[0]); }, 1},
+    {"asin", [](const double* a) { return std::asin(a[0]); }, 1},
+    {"atan", [](const double* a) { return std::atan(a[0]); }, 1},
+    {"atan2", [](const double* a) { return std::atan2(a[0], a[1]); }, 2},
+    {"cbrt", [](const double* a) { return std::cbrt(a[0]); }, 1},
+    {"ceil", [](const double* a) { return std::ceil(a[0]); }, 1},
+    {"cos", [](const double* a) { return std::cos(a[0]); }, 1},
+    {"cosh", [](const double* a) { return std::cosh(a[0]); }, 1},
+    {"exp", [](const double* a) { return std::exp(a[0]); }, 1},
+    {"floor", [](const double* a) { return std::floor(a[0]); }, 1},
+    {"hypot", [](const double* a) { return std::hypot(a[0], a[1]); }, 2},
+    {"ln", [](const double* a) { return std::log(a[0]); }, 1},
+    {"log10", [](const double* a) { return std::log10(a[0]); }, 1},
+    {"log2", [](const double* a) { return std::log2(a[0]); }, 1},
+    {"max", [](const double* a) { return builtin_math::max(a[0], a[1]); }, 2},
+    {"min", [](const double* a) { return builtin_math::min(a[0], a[1]); }, 2},
+    {"round", [](const double* a) { return std::round(a[0]); }, 1},
+    {"sin", [](const double* a) { return std::sin(a[0]); }, 1},
+    {"sinh", [](const double* a) { return std::sinh(a[0]); }, 1},
+    {"sqrt", [](const double* a) { return std::sqrt(a[0]); }, 1},
+    {"tan", [](const double* a) { return std::tan(a[0]); }, 1},
+    {"tanh", [](const double* a) { return std::tanh(a[0]); }, 1},
+    {"trunc", [](const double* a) { return std::trunc(a[0]); }, 1},
+};
+
+constexpr bool isSortedByName() {
+    for (size_t i = 1; i < std::size(kBuiltins); i++) {
+        if (!(kBuiltins[i - 1].name < kBuiltins[i].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(isSortedByName(), "kBuiltins must be sorted by name");
+
+bool isIdentifier(std::string_view name) {
+    if (name.empty() || !(isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+} // namespace
+
+FunctionTable::FunctionTable() : m_functions(std::begin(kBuiltins), std::end(kBuiltins)) {}
+
+const FunctionTable& FunctionTable::builtins() {
+    static const FunctionTable table;
+    return table;
+}
+
+uint16_t FunctionTable::add(std::string_view name, size_t arity, Callback call) {
+    if (!isIdentifier(name)) {
+        throw std::runtime_error("Invalid function name: " + std::string(name));
+    }
+    if (arity == 0 || arity > kMaxArity) {
+        throw std::runtime_error("Function arity must be between 1 and " + std::to_string(kMaxArity));
+    }
+    if (find(name)) {
+        throw std::runtime_error("Function already defined: " + std::string(name));
+    }
+    if (m_functions.size() >= kNoFunction) {
+        throw std::runtime_error("Too many functions");
+    }
+
+    auto id = static_cast<uint16_t>(m_functions.size());
+    // Deque elements never move, so the stored name can back both the entry and the lookup key
+    std::string_view stored = m_names.emplace_back(name);
+    m_added.emplace(stored, id);
+    m_functions.push_back({stored, call, static_cast<uint8_t>(arity)});
+    return id;
+}
+
+std::optional<uint16_t> FunctionTable::find(std::string_view name) const {
+    const Function* builtin = std::lower_bound(std::begin(kBuiltins), std::end(kBuiltins), name,
+                                               [](const Function& function, std::string_view key) {
+                                                   return function.name < key;
+                                               });
+    if (builtin != std::end(kBuiltins) && builtin->name == name) {
+        return static_cast<uint16_t>(builtin - std::begin(kBuiltins));
+    }
+    auto it = m_added.find(name);
+    if (it == m_added.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
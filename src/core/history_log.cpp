@@ -0,0 +1,203 @@
+#include "calculator/history_log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct HistoryLog::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;    // Committed entries
+    uint64_t textSize; // Committed bytes of the text file
+    double memory;
+    uint8_t reserved[24];
+};
+
+struct HistoryLog::Record {
+    int64_t timestamp;
+    double value;
+    uint64_t textOffset;
+    uint32_t textLength;
+    uint8_t error;
+    uint8_t reserved[3];
+};
+
+namespace {
+constexpr char kMagic[8] = {'C', 'A', 'L', 'C', 'H', 'I', 'S', 'T'};
+constexpr uint32_t kVersion = 1;
+
+// Initial file sizes; both double whenever an append does not fit
+constexpr size_t kInitialRecords = 1024;
+constexpr size_t kInitialTextBytes = 64 * 1024;
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+} // namespace
+
+HistoryLog::HistoryLog(const std::string& path) {
+    static_assert(sizeof(Header) == 64, "The header is part of the file format");
+    static_assert(sizeof(Record) == 32, "Records are part of the file format");
+
+    try {
+        openFile(m_records, path);
+        openFile(m_text, path + ".text");
+
+        if (m_records.capacity == 0) {
+            map(m_records, sizeof(Header) + kInitialRecords * sizeof(Record));
+            Header* created = header();
+            std::memcpy(created->magic, kMagic, sizeof(kMagic));
+            created->version = kVersion;
+            created->recordSize = sizeof(Record);
+            created->count = 0;
+            created->textSize = 0;
+            created->memory = 0.0;
+        }
+
+        const Header* existing = header();
+        if (m_records.capacity < sizeof(Header) || std::memcmp(existing->magic, kMagic, sizeof(kMagic)) != 0 ||
+            existing->version != kVersion || existing->recordSize != sizeof(Record) ||
+            existing->count > (m_records.capacity - sizeof(Header)) / sizeof(Record) ||
+            existing->textSize > m_text.capacity) {
+            throw std::runtime_error("Not a valid history log: " + path);
+        }
+
+        if (m_text.capacity == 0) {
+            map(m_text, kInitialTextBytes);
+        }
+    } catch (...) {
+        closeFile(m_text);
+        closeFile(m_records);
+        throw;
+    }
+}
+
+HistoryLog::~HistoryLog() {
+    closeFile(m_text);
+    closeFile(m_records);
+}
+
+void HistoryLog::append(std::string_view expression, const CalcResult& result) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    append(expression, result, std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+void HistoryLog::append(std::string_view expression, const CalcResult& result, int64_t timestamp) {
+    if (expression.size() > UINT32_MAX) {
+        throw std::runtime_error("Expression too long for the history log");
+    }
+    const uint64_t count = header()->count;
+    const uint64_t textSize = header()->textSize;
+    reserve(m_text, textSize + expression.size());
+    reserve(m_records, sizeof(Header) + (count + 1) * sizeof(Record));
+
+    std::memcpy(m_text.data + textSize, expression.data(), expression.size());
+    Record& record = records()[count];
+    record = {};
+    record.timestamp = timestamp;
+    record.value = result.value;
+    record.textOffset = textSize;
+    record.textLength = static_cast<uint32_t>(expression.size());
+    record.error = static_cast<uint8_t>(result.error);
+
+    // Publishing the counts commits the entry
+    header()->textSize = textSize + expression.size();
+    header()->count = count + 1;
+}
+
+size_t HistoryLog::size() const { return header()->count; }
+
+HistoryLog::Entry HistoryLog::operator[](size_t index) const {
+    const Record& record = records()[index];
+    Entry entry{record.timestamp, record.value, CalcError::None, {}};
+    if (record.error < static_cast<uint8_t>(CalcError::Count)) {
+        entry.error = static_cast<CalcError>(record.error);
+    }
+    // Offsets come from disk, so keep a damaged record from reading outside the text
+    if (record.textOffset <= header()->textSize && record.textLength <= header()->textSize - record.textOffset) {
+        entry.expression = std::string_view(m_text.data + record.textOffset, record.textLength);
+    }
+    return entry;
+}
+
+double HistoryLog::memory() const { return header()->memory; }
+
+void HistoryLog::setMemory(double value) { header()->memory = value; }
+
+HistoryLog::Header* HistoryLog::header() const { return reinterpret_cast<Header*>(m_records.data); }
+
+HistoryLog::Record* HistoryLog::records() const {
+    return reinterpret_cast<Record*>(m_records.data + sizeof(Header));
+}
+
+void HistoryLog::reserve(MappedFile& file, size_t bytes) {
+    if (bytes > file.capacity) {
+        map(file, std::max(bytes, file.capacity * 2));
+    }
+}
+
+#if !defined(_WIN32)
+void HistoryLog::openFile(MappedFile& file, const std::string& path) {
+    file.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file.fd < 0) {
+        fail("Cannot open history log " + path);
+    }
+    // Both files are guarded by the lock on the first; the lock goes away with the descriptor
+    if (::flock(file.fd, LOCK_EX | LOCK_NB) != 0) {
+        fail("Cannot lock history log " + path);
+    }
+    struct stat info {};
+    if (::fstat(file.fd, &info) != 0) {
+        fail("Cannot read history log " + path);
+    }
+    if (info.st_size > 0) {
+        map(file, static_cast<size_t>(info.st_size));
+    }
+}
+
+void HistoryLog::map(MappedFile& file, size_t capacity) {
+    // The old mapping stays until the new one exists, so a failed grow leaves the log as it was. Files only
+    // grow, so this is a no-op when mapping an existing file at its size
+    if (::ftruncate(file.fd, static_cast<off_t>(capacity)) != 0) {
+        fail("Cannot grow history log");
+    }
+    void* mapping = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+    if (mapping == MAP_FAILED) {
+        fail("Cannot map history log");
+    }
+    if (file.data) {
+        ::munmap(file.data, file.capacity);
+    }
+    file.data = static_cast<char*>(mapping);
+    file.capacity = capacity;
+}
+
+void HistoryLog::closeFile(MappedFile& file) {
+    if (file.data) {
+        ::munmap(file.data, file.capacity);
+    }
+    if (file.fd >= 0) {
+        ::close(file.fd);
+    }
+    file = {};
+}
+#else
+void HistoryLog::openFile(MappedFile&, const std::string&) {
+    throw std::runtime_error("The history log is not supported on this platform");
+}
+
+void HistoryLog::map(MappedFile&, size_t) {}
+
+void HistoryLog::closeFile(MappedFile& file) { file = {}; }
+#endif
@@ -0,0 +1,357 @@
+#include "calculator/incremental_evaluator.hpp"
+
+#include "calculator/calculator_core.hpp"
+#include "calculator/operator_precedence.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <optional>
+
+namespace {
+bool isBinaryOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '/' || c == '^'; }
+
+bool isIdentifierStart(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+
+bool isNumberCharacter(char c) { return isdigit(static_cast<unsigned char>(c)) || c == '.'; }
+
+void recordFirst(CalcResult& slot, CalcError error, uint32_t position) {
+    if (slot.ok()) {
+        slot = CalcResult::failure(error, position);
+    }
+}
+} // namespace
+
+IncrementalEvaluator::IncrementalEvaluator(const FunctionTable& functions) : m_functions(&functions) {
+    m_states.emplace_back();
+}
+
+void IncrementalEvaluator::push(std::string_view characters) {
+    for (char c : characters) {
+        State state = m_states.back();
+        auto position = static_cast<uint32_t>(m_text.size());
+        m_text.push_back(c);
+        if (state.error.ok()) {
+            process(state, c, position);
+        }
+        state.valueCount = static_cast<uint32_t>(m_values.size());
+        state.operatorCount = static_cast<uint32_t>(m_operators.size());
+        m_states.push_back(state);
+    }
+}
+
+void IncrementalEvaluator::pop() {
+    if (m_text.empty()) {
+        return;
+    }
+    m_text.pop_back();
+    m_states.pop_back();
+    // Nodes created after the restored state are referenced by no remaining state
+    m_values.resize(m_states.back().valueCount);
+    m_operators.resize(m_states.back().operatorCount);
+}
+
+void IncrementalEvaluator::clear() {
+    m_text.clear();
+    m_states.resize(1);
+    m_values.clear();
+    m_operators.clear();
+}
+
+void IncrementalEvaluator::assign(std::string_view text) {
+    size_t common = std::mismatch(m_text.begin(), m_text.begin() + std::min(m_text.size(), text.size()), text.begin())
+                        .first -
+                    m_text.begin();
+    while (m_text.size() > common) {
+        pop();
+    }
+    push(text.substr(common));
+}
+
+void IncrementalEvaluator::process(State& state, char c, uint32_t position) {
+    if (state.tokenStart != kNil) {
+        bool identifier = isIdentifierStart(m_text[state.tokenStart]);
+        bool continues = identifier ? isIdentifierStart(c) || isdigit(static_cast<unsigned char>(c)) : isNumberCharacter(c);
+        if (continues) {
+            return;
+        }
+        if (identifier && c == '(') {
+            startCall(state, position);
+            return;
+        }
+        finishToken(state, position);
+        if (!state.error.ok()) {
+            return;
+        }
+    }
+
+    if (isspace(static_cast<unsigned char>(c))) {
+        return;
+    }
+
+    if (isNumberCharacter(c) || isIdentifierStart(c)) {
+        if (!state.expectOperand) {
+            state.error = CalcResult::failure(CalcError::TooManyOperands, position);
+            return;
+        }
+        state.tokenStart = position;
+        state.expectOperand = false;
+        state.sawToken = true;
+    } else if (c == '(') {
+        if (!state.expectOperand) {
+            state.error = CalcResult::failure(CalcError::TooManyOperands, position);
+            return;
+        }
+        pushOperator(state, c, position);
+        state.openParentheses++;
+        state.sawToken = true;
+    } else if (c == ')') {
+        if (state.expectOperand) {
+            state.error = CalcResult::failure(CalcError::NotEnoughOperands, position);
+            return;
+        }
+        while (state.operators != kNil && m_operators[state.operators].op != '(') {
+            reduce(state);
+        }
+        if (state.operators == kNil) {
+            state.error = CalcResult::failure(CalcError::MismatchedParentheses, position);
+            return;
+        }
+        const OperatorNode open = m_operators[state.operators];
+        state.operators = open.next;
+        state.openParentheses--;
+        if (open.function != FunctionTable::kNoFunction) {
+            const FunctionTable::Function& function = (*m_functions)[open.function];
+            if (open.arguments + 1u != function.arity) {
+                state.error = CalcResult::failure(CalcError::WrongArgumentCount, position);
+                return;
+            }
+            uint32_t values = m_values[state.values].next;
+            double result = call(function, m_values[state.values].value, values);
+            state.values = pushValue(result, values);
+        }
+    } else if (c == ',') {
+        separate(state, position);
+    } else if (isBinaryOperator(c)) {
+        if (state.expectOperand) {
+            // An operator is unary when no operand precedes it
+            if (c == '-') {
+                pushOperator(state, '~', position);
+                state.sawToken = true;
+            } else if (c != '+') {
+                state.error = CalcResult::failure(CalcError::NotEnoughOperands, position);
+            }
+            return;
+        }
+        // The same reductions shuntingYard performs before pushing an operator
+        while (state.operators != kNil) {
+            char top = m_operators[state.operators].op;
+            if (top == '(' || operatorPrecedence(top) < operatorPrecedence(c) ||
+                (operatorPrecedence(top) == operatorPrecedence(c) && operatorIsRightAssociative(c))) {
+                break;
+            }
+            reduce(state);
+        }
+        pushOperator(state, c, position);
+        state.expectOperand = true;
+    } else {
+        state.error = CalcResult::failure(CalcError::InvalidCharacter, position);
+    }
+}
+
+void IncrementalEvaluator::finishToken(State& state, uint32_t end) {
+    uint32_t start = state.tokenStart;
+    state.tokenStart = kNil;
+    if (isIdentifierStart(m_text[start])) {
+        // There are no variable bindings here, as in CalculatorCore::calculate
+        recordFirst(state.evalError, CalcError::UnboundVariable, start);
+        state.values = pushValue(std::numeric_limits<double>::quiet_NaN(), state.values);
+        return;
+    }
+    double value = 0.0;
+    auto [last, ec] = std::from_chars(m_text.data() + start, m_text.data() + end, value);
+    if (ec != std::errc() || last != m_text.data() + end) {
+        state.error = CalcResult::failure(CalcError::InvalidNumber, start);
+        return;
+    }
+    state.values = pushValue(value, state.values);
+}
+
+void IncrementalEvaluator::startCall(State& state, uint32_t position) {
+    uint32_t start = state.tokenStart;
+    state.tokenStart = kNil;
+    std::optional<uint16_t> id = m_functions->find(std::string_view(m_text).substr(start, position - start));
+    if (!id) {
+        state.error = CalcResult::failure(CalcError::UnknownFunction, start);
+        return;
+    }
+    pushOperator(state, '(', position, *id);
+    state.openParentheses++;
+    // The name was taken for an operand when it started; the call's arguments are still to come
+    state.expectOperand = true;
+}
+
+void IncrementalEvaluator::separate(State& state, uint32_t position) {
+    if (state.expectOperand) {
+        state.error = CalcResult::failure(CalcError::NotEnoughOperands, position);
+        return;
+    }
+    while (state.operators != kNil && m_operators[state.operators].op != '(') {
+        reduce(state);
+    }
+    // Only a call's parentheses may hold separators, and one fewer than the function's arity
+    if (state.operators == kNil || m_operators[state.operators].function == FunctionTable::kNoFunction) {
+        state.error = CalcResult::failure(CalcError::WrongArgumentCount, position);
+        return;
+    }
+    const OperatorNode open = m_operators[state.operators];
+    if (open.arguments + 1u >= (*m_functions)[open.function].arity) {
+        state.error = CalcResult::failure(CalcError::WrongArgumentCount, position);
+        return;
+    }
+    // The node is shared with earlier states, so the new count goes into a replacement
+    state.operators = open.next;
+    pushOperator(state, '(', open.position, open.function, static_cast<uint8_t>(open.arguments + 1));
+    state.expectOperand = true;
+}
+
+void IncrementalEvaluator::reduce(State& state) {
+    // Nodes are shared with earlier states, so results are pushed as new nodes rather than written in place
+    const OperatorNode op = m_operators[state.operators];
+    state.operators = op.next;
+
+    const ValueNode right = m_values[state.values];
+    if (op.op == '~') {
+        state.values = pushValue(-right.value, right.next);
+        return;
+    }
+    const ValueNode left = m_values[right.next];
+    CalcResult result = CalculatorCore::applyOperation(op.op, left.value, right.value);
+    if (!result.ok()) {
+        recordFirst(state.evalError, result.error, op.position);
+    }
+    state.values = pushValue(result.value, left.next);
+}
+
+uint32_t IncrementalEvaluator::pushValue(double value, uint32_t next) {
+    m_values.push_back({value, next});
+    return static_cast<uint32_t>(m_values.size() - 1);
+}
+
+void IncrementalEvaluator::pushOperator(State& state, char op, uint32_t position, uint16_t function,
+                                        uint8_t arguments) {
+    m_operators.push_back({op, arguments, function, position, state.operators});
+    state.operators = static_cast<uint32_t>(m_operators.size() - 1);
+}
+
+double IncrementalEvaluator::call(const FunctionTable::Function& function, double last, uint32_t& values) const {
+    double arguments[FunctionTable::kMaxArity];
+    arguments[function.arity - 1] = last;
+    for (size_t i = function.arity - 1; i-- > 0;) {
+        arguments[i] = m_values[values].value;
+        values = m_values[values].next;
+    }
+    return function.call(arguments);
+}
+
+IncrementalEvaluator::Preview IncrementalEvaluator::preview() const {
+    const State& state = m_states.back();
+    Preview preview;
+    if (!state.error.ok()) {
+        preview.status = Preview::Invalid;
+        preview.error = state.error;
+        return preview;
+    }
+    if (!state.sawToken) {
+        return preview;
+    }
+
+    CalcResult evalError = state.evalError;
+    bool partial = state.openParentheses > 0;
+    bool haveOperand = false;
+    double operand = 0.0;
+    uint32_t values = state.values;
+    uint32_t operators = state.operators;
+
+    // The operand on top: the token being typed, or the last reduced value
+    if (state.tokenStart != kNil) {
+        std::string_view token(m_text.data() + state.tokenStart, m_text.size() - state.tokenStart);
+        if (isIdentifierStart(token[0])) {
+            recordFirst(evalError, CalcError::UnboundVariable, state.tokenStart);
+            operand = std::numeric_limits<double>::quiet_NaN();
+            haveOperand = true;
+        } else {
+            auto [last, ec] = std::from_chars(token.data(), token.data() + token.size(), operand);
+            if (ec == std::errc() && last == token.data() + token.size()) {
+                haveOperand = true;
+            } else if (token != ".") {
+                preview.status = Preview::Invalid;
+                preview.error = CalcResult::failure(CalcError::InvalidNumber, state.tokenStart);
+                return preview;
+            }
+        }
+    } else if (!state.expectOperand) {
+        operand = m_values[values].value;
+        values = m_values[values].next;
+        haveOperand = true;
+    }
+
+    // Mid-entry: drop dangling '(' and unary minus, then the binary operator still waiting for its right operand
+    if (!haveOperand) {
+        partial = true;
+        while (operators != kNil && !haveOperand) {
+            const OperatorNode& node = m_operators[operators];
+            char op = node.op;
+            operators = node.next;
+            if (op == '(') {
+                // An open call's completed arguments go with it
+                for (uint8_t i = 0; i < node.arguments; i++) {
+                    values = m_values[values].next;
+                }
+            } else if (op != '~') {
+                operand = m_values[values].value;
+                values = m_values[values].next;
+                haveOperand = true;
+            }
+        }
+    }
+
+    // Fold what is pending, right to left, as if every open parenthesis were closed
+    for (; haveOperand && operators != kNil; operators = m_operators[operators].next) {
+        const OperatorNode& op = m_operators[operators];
+        if (op.op == '(') {
+            if (op.function == FunctionTable::kNoFunction) {
+                continue;
+            }
+            const FunctionTable::Function& function = (*m_functions)[op.function];
+            if (op.arguments + 1u != function.arity) {
+                // Arguments are still missing, so nothing from here out has a value yet
+                haveOperand = false;
+                break;
+            }
+            operand = call(function, operand, values);
+            continue;
+        }
+        if (op.op == '~') {
+            operand = -operand;
+            continue;
+        }
+        CalcResult result = CalculatorCore::applyOperation(op.op, m_values[values].value, operand);
+        if (!result.ok()) {
+            recordFirst(evalError, result.error, op.position);
+        }
+        operand = result.value;
+        values = m_values[values].next;
+    }
+
+    if (!evalError.ok()) {
+        preview.status = Preview::Invalid;
+        preview.error = evalError;
+        return preview;
+    }
+    preview.status = partial ? Preview::Partial : Preview::Complete;
+    preview.hasValue = haveOperand;
+    preview.value = operand;
+    return preview;
+}
@@ -0,0 +1,252 @@
+#include "pratt_parser.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <optional>
+
+namespace {
+// Binding power of unary minus: it takes only '^' into its operand, so -2^2 == -(2^2)
+constexpr char kNegate = '~';
+} // namespace
+
+bool PrattParser::run(CalcResult& result) {
+    double value = parseExpression(0);
+
+    // A ')' or ',' can only surface here when it has no matching '(' or enclosing call; record it and keep
+    // going so that any later lexical error still wins, as it does in the tokenize-first pipeline
+    while (!m_stopped) {
+        skipSpace();
+        if (m_pos >= m_expression.size()) {
+            break;
+        }
+        if (atSeparator()) {
+            skipStraySeparators();
+            continue;
+        }
+        record(m_parenError, CalcError::MismatchedParentheses, m_pos++);
+        m_tokens++;
+        value = parseInfix(value, 0);
+    }
+
+    if (m_tooDeep) {
+        return false;
+    }
+    if (!m_lexError.ok()) {
+        result = m_lexError;
+    } else if (!m_parenError.ok()) {
+        result = m_parenError;
+    } else if (!m_evalError.ok()) {
+        result = m_evalError;
+    } else {
+        result = CalcResult::success(value);
+    }
+    return true;
+}
+
+double PrattParser::parseExpression(int minPrecedence) {
+    if (++m_depth > kMaxDepth) {
+        m_tooDeep = true;
+        m_stopped = true;
+        return 0.0;
+    }
+    double value = parsePrefix();
+    value = parseInfix(value, minPrecedence);
+    m_depth--;
+    return value;
+}
+
+double PrattParser::parseInfix(double left, int minPrecedence) {
+    while (!m_stopped) {
+        skipSpace();
+        if (m_pos >= m_expression.size() || m_expression[m_pos] == ')' || m_expression[m_pos] == ',') {
+            break;
+        }
+
+        char c = m_expression[m_pos];
+        if (!CalculatorCore::isOperator(c)) {
+            bool operand = isdigit(c) || c == '.' || c == '(' || CalculatorCore::isIdentifierStart(c);
+            stop(operand ? CalcError::TooManyOperands : CalcError::InvalidCharacter, m_pos);
+            break;
+        }
+
+        int precedence = CalculatorCore::getPrecedence(c);
+        if (precedence < minPrecedence) {
+            break;
+        }
+
+        size_t position = m_pos++;
+        m_tokens++;
+        double right = parseExpression(CalculatorCore::isRightAssociative(c) ? precedence : precedence + 1);
+        if (m_stopped) {
+            break;
+        }
+
+        CalcResult applied = CalculatorCore::applyOperation(c, left, right);
+        if (!applied.ok()) {
+            record(m_evalError, applied.error, position);
+        }
+        left = applied.value;
+    }
+    return left;
+}
+
+double PrattParser::parsePrefix() {
+    while (true) {
+        skipSpace();
+        if (m_pos >= m_expression.size()) {
+            if (m_sawToken) {
+                stop(CalcError::NotEnoughOperands, m_expression.size());
+            } else {
+                stop(CalcError::EmptyExpression, 0);
+            }
+            return 0.0;
+        }
+
+        size_t start = m_pos;
+        char c = m_expression[m_pos];
+
+        // Every operand passes through here, so polling per prefix token bounds the work between checks
+        if (CalculatorCore::cancelRequested(m_cancelFlag, m_polls++)) {
+            stop(CalcError::Cancelled, start);
+            return 0.0;
+        }
+
+        if (isdigit(c) || c == '.') {
+            m_sawToken = true;
+            m_tokens++;
+            while (m_pos < m_expression.size() && (isdigit(m_expression[m_pos]) || m_expression[m_pos] == '.')) {
+                m_pos++;
+            }
+            double value = 0.0;
+            auto [end, ec] = std::from_chars(m_expression.data() + start, m_expression.data() + m_pos, value);
+            if (ec != std::errc() || end != m_expression.data() + m_pos) {
+                stop(CalcError::InvalidNumber, start);
+            }
+            return value;
+        }
+
+        if (CalculatorCore::isIdentifierStart(c)) {
+            m_sawToken = true;
+            m_tokens++;
+            while (m_pos < m_expression.size() &&
+                   (CalculatorCore::isIdentifierStart(m_expression[m_pos]) || isdigit(m_expression[m_pos]))) {
+                m_pos++;
+            }
+            if (m_pos < m_expression.size() && m_expression[m_pos] == '(') {
+                return parseCall(start);
+            }
+            // Direct evaluation has no variable bindings
+            record(m_evalError, CalcError::UnboundVariable, start);
+            return 0.0;
+        }
+
+        if (c == '(') {
+            m_sawToken = true;
+            m_tokens++;
+            m_pos++;
+            double value = parseExpression(0);
+            skipStraySeparators();
+            if (m_stopped) {
+                return value;
+            }
+            skipSpace();
+            if (m_pos < m_expression.size()) {
+                m_pos++; // parseInfix only stops early at ')' and ',', and there is no ',' left
+                m_tokens++;
+            } else {
+                record(m_parenError, CalcError::MismatchedParentheses, start);
+            }
+            return value;
+        }
+
+        if (c == '-') {
+            m_sawToken = true;
+            m_tokens++;
+            m_pos++;
+            return -parseExpression(CalculatorCore::getPrecedence(kNegate) + 1);
+        }
+
+        if (c == '+') {
+            // Unary plus is a no-op, as in tokenize
+            m_pos++;
+            continue;
+        }
+
+        stop(c == ')' || c == ',' || CalculatorCore::isOperator(c) ? CalcError::NotEnoughOperands
+                                                                    : CalcError::InvalidCharacter,
+             start);
+        return 0.0;
+    }
+}
+
+double PrattParser::parseCall(size_t start) {
+    std::optional<uint16_t> id = m_functions.find(m_expression.substr(start, m_pos - start));
+    if (!id) {
+        stop(CalcError::UnknownFunction, start);
+        return 0.0;
+    }
+    const FunctionTable::Function& function = m_functions[*id];
+    size_t open = m_pos++;
+    m_tokens++;
+
+    double arguments[FunctionTable::kMaxArity];
+    for (size_t count = 1;; count++) {
+        double value = parseExpression(0);
+        if (m_stopped) {
+            return 0.0;
+        }
+        if (count <= function.arity) {
+            arguments[count - 1] = value;
+        }
+        skipSpace();
+        if (m_pos >= m_expression.size()) {
+            record(m_parenError, CalcError::MismatchedParentheses, open);
+            return 0.0;
+        }
+        // parseInfix only stops early at ')' and ','; either one ends this argument
+        size_t position = m_pos++;
+        m_tokens++;
+        if (m_expression[position] == ')') {
+            if (count != function.arity) {
+                record(m_parenError, CalcError::WrongArgumentCount, position);
+                return 0.0;
+            }
+            return function.call(arguments);
+        }
+        if (count >= function.arity) {
+            record(m_parenError, CalcError::WrongArgumentCount, position);
+        }
+    }
+}
+
+void PrattParser::skipStraySeparators() {
+    while (!m_stopped && atSeparator()) {
+        record(m_parenError, CalcError::WrongArgumentCount, m_pos++);
+        m_tokens++;
+        parseExpression(0);
+    }
+}
+
+bool PrattParser::atSeparator() {
+    skipSpace();
+    return m_pos < m_expression.size() && m_expression[m_pos] == ',';
+}
+
+void PrattParser::skipSpace() {
+    while (m_pos < m_expression.size() && isspace(m_expression[m_pos])) {
+        m_pos++;
+    }
+}
+
+void PrattParser::stop(CalcError error, size_t position) {
+    m_stopped = true;
+    record(m_lexError, error, position);
+}
+
+void PrattParser::record(CalcResult& slot, CalcError error, size_t position) {
+    if (slot.ok()) {
+        slot = CalcResult::failure(error, static_cast<uint32_t>(position));
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CALCULATOR_PRATT_PARSER_H
+#define CALCULATOR_PRATT_PARSER_H
+
+#include "calculator/calc_result.hpp"
+#include "calculator/function_table.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @class PrattParser
+ * @brief Single-pass engine that lexes, parses and evaluates an expression without intermediate buffers
+ *
+ * Operator precedence and semantics come from CalculatorCore::getPrecedence and applyOperation. To report
+ * the same error as the tokenize/shuntingYard/evaluatePostfix pipeline, parenthesis and evaluation errors
+ * are recorded and parsing continues; a lexical error ends parsing immediately and takes priority, then
+ * parenthesis errors, then evaluation errors.
+ */
+class PrattParser {
+public:
+    /**
+     * @brief Nesting beyond this depth aborts the parse so deep inputs cannot overflow the call stack
+     */
+    static constexpr size_t kMaxDepth = 2048;
+
+    /**
+     * @param functions Resolves function calls; must outlive the parser
+     * @param cancelFlag Polled as by CalculatorCore::setCancellationFlag; may be nullptr
+     */
+    PrattParser(std::string_view expression, const FunctionTable& functions,
+                const std::atomic<bool>* cancelFlag = nullptr)
+        : m_expression(expression), m_functions(functions), m_cancelFlag(cancelFlag) {}
+
+    /**
+     * @brief Evaluate the whole expression
+     * @param result Set to the value or the first error, as the RPN pipeline would report it
+     * @return false if the expression nests deeper than kMaxDepth; @p result is then unset
+     */
+    bool run(CalcResult& result);
+
+    /**
+     * @brief Tokens consumed so far, counted as tokenize would emit them
+     */
+    size_t tokenCount() const { return m_tokens; }
+
+private:
+    std::string_view m_expression;
+    const FunctionTable& m_functions;
+    const std::atomic<bool>* m_cancelFlag;
+    size_t m_pos = 0;
+    size_t m_depth = 0;
+    size_t m_tokens = 0;
+    size_t m_polls = 0; // Prefix tokens seen; m_tokens grows by varying steps between them
+    bool m_sawToken = false;
+    bool m_stopped = false;
+    bool m_tooDeep = false;
+    CalcResult m_lexError;
+    CalcResult m_parenError;
+    CalcResult m_evalError;
+
+    double parseExpression(int minPrecedence);
+    double parseInfix(double left, int minPrecedence);
+    double parsePrefix();
+
+    /**
+     * @brief Parse the arguments of a call whose name spans [@p start, m_pos), with m_pos at its '('
+     */
+    double parseCall(size_t start);
+
+    /**
+     * @brief Consume a ',' where the grammar allows none, then parse the operand that must follow it
+     */
+    void skipStraySeparators();
+
+    bool atSeparator();
+    void skipSpace();
+    void stop(CalcError error, size_t position);
+    static void record(CalcResult& slot, CalcError error, size_t position);
+};
+
+#endif // CALCULATOR_PRATT_PARSER_H
@@ -0,0 +1,122 @@
+#include "calculator/result_cache.hpp"
+
+#include "calculator/calculator_core.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+bool isWordChar(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '_'; }
+} // namespace
+
+ResultCache::ResultCache(size_t capacity, size_t shards) {
+    shards = std::max<size_t>(1, shards);
+    m_shardCapacity = std::max<size_t>(1, (capacity + shards - 1) / shards);
+    m_shards.reserve(shards);
+    for (size_t i = 0; i < shards; i++) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+ResultCache::~ResultCache() {}
+
+double ResultCache::calculate(CalculatorCore& calculator, std::string_view expression) {
+    // Reused per thread so a hit never allocates for the key
+    thread_local std::string key;
+    normalize(expression, key);
+
+    Shard& shard = *m_shards[std::hash<std::string_view>{}(key) % m_shards.size()];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.stats.hits++;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return resolve(*it->second);
+        }
+        shard.stats.misses++;
+    }
+
+    // Evaluate outside the lock so a slow expression does not block the rest of the shard
+    Entry entry{key, 0.0, {}};
+    CalcResult result = calculator.tryCalculate(expression);
+    if (result.error == CalcError::Cancelled) {
+        // Says nothing about the expression, so the next caller must evaluate it again
+        throw std::runtime_error(formatError(result, expression));
+    }
+    if (result.ok()) {
+        entry.value = result.value;
+    } else {
+        entry.error = formatError(result, expression);
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.find(key) == shard.index.end()) {
+        shard.entries.push_front(std::move(entry));
+        shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+        if (shard.entries.size() > m_shardCapacity) {
+            shard.index.erase(shard.entries.back().key);
+            shard.entries.pop_back();
+            shard.stats.evictions++;
+        }
+        return resolve(shard.entries.front());
+    }
+    return resolve(entry);
+}
+
+CacheStats ResultCache::stats() const {
+    CacheStats total;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->stats.hits;
+        total.misses += shard->stats.misses;
+        total.evictions += shard->stats.evictions;
+    }
+    return total;
+}
+
+size_t ResultCache::size() const {
+    size_t total = 0;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->entries.size();
+    }
+    return total;
+}
+
+void ResultCache::clear() {
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->entries.clear();
+    }
+}
+
+void ResultCache::normalize(std::string_view expression, std::string& key) {
+    // Write through a raw pointer into a pre-sized buffer; the key is never longer than the input
+    key.resize(expression.size());
+    char* out = key.data();
+    char* begin = out;
+    bool pendingSpace = false;
+    for (char c : expression) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && out != begin && isWordChar(out[-1]) && (isWordChar(c) || c == '(')) {
+            *out++ = ' ';
+        }
+        pendingSpace = false;
+        *out++ = c;
+    }
+    key.resize(out - begin);
+}
+
+double ResultCache::resolve(const Entry& entry) {
+    if (!entry.error.empty()) {
+        throw std::runtime_error(entry.error);
+    }
+    return entry.value;
+}
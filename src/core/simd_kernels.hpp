@@ -0,0 +1,145 @@
+#ifndef CALCULATOR_SIMD_KERNELS_H
+#define CALCULATOR_SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CALCULATOR_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CALCULATOR_SIMD_SSE2 1
+#endif
+
+/**
+ * @brief Element-wise kernels used by BatchEvaluator
+ *
+ * Inputs may alias the output. Each kernel runs a vector body followed by a scalar tail.
+ */
+namespace simd {
+
+#if defined(CALCULATOR_SIMD_AVX2)
+constexpr size_t kLanes = 4;
+using Vec = __m256d;
+inline Vec load(const double* p) { return _mm256_loadu_pd(p); }
+inline void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+inline Vec broadcast(double v) { return _mm256_set1_pd(v); }
+inline Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+inline Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+inline Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+inline Vec isZero(Vec v) { return _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_EQ_OQ); }
+inline Vec bitOr(Vec a, Vec b) { return _mm256_or_pd(a, b); }
+inline Vec bitXor(Vec a, Vec b) { return _mm256_xor_pd(a, b); }
+#elif defined(CALCULATOR_SIMD_SSE2)
+constexpr size_t kLanes = 2;
+using Vec = __m128d;
+inline Vec load(const double* p) { return _mm_loadu_pd(p); }
+inline void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+inline Vec broadcast(double v) { return _mm_set1_pd(v); }
+inline Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+inline Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+inline Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+inline Vec isZero(Vec v) { return _mm_cmpeq_pd(v, _mm_setzero_pd()); }
+inline Vec bitOr(Vec a, Vec b) { return _mm_or_pd(a, b); }
+inline Vec bitXor(Vec a, Vec b) { return _mm_xor_pd(a, b); }
+#else
+constexpr size_t kLanes = 1;
+#endif
+
+/**
+ * @brief Sets a mask element to all-ones bits when @p flag is true
+ */
+inline void orMask(double& mask, bool flag) {
+    if (flag) {
+        std::uint64_t bits = ~std::uint64_t{0};
+        std::memcpy(&mask, &bits, sizeof(mask));
+    }
+}
+
+/**
+ * @brief Checks whether a mask element has any bit set
+ */
+inline bool isMasked(double mask) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &mask, sizeof(bits));
+    return bits != 0;
+}
+
+inline void fill(double* out, double value, size_t n) {
+    size_t i = 0;
+#if defined(CALCULATOR_SIMD_AVX2) || defined(CALCULATOR_SIMD_SSE2)
+    Vec v = broadcast(value);
+    for (; i + kLanes <= n; i += kLanes) {
+        store(out + i, v);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = value;
+    }
+}
+
+inline void negate(double* out, const double* a, size_t n) {
+    size_t i = 0;
+#if defined(CALCULATOR_SIMD_AVX2) || defined(CALCULATOR_SIMD_SSE2)
+    // Flipping the sign bit matches scalar negation, including for zeros and NaN
+    Vec signBit = broadcast(-0.0);
+    for (; i + kLanes <= n; i += kLanes) {
+        store(out + i, bitXor(load(a + i), signBit));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = -a[i];
+    }
+}
+
+#if defined(CALCULATOR_SIMD_AVX2) || defined(CALCULATOR_SIMD_SSE2)
+#define CALCULATOR_SIMD_BINARY_KERNEL(name, op)                                                                        \
+    inline void name(double* out, const double* a, const double* b, size_t n) {                                        \
+        size_t i = 0;                                                                                                  \
+        for (; i + kLanes <= n; i += kLanes) {                                                                         \
+            store(out + i, name(load(a + i), load(b + i)));                                                            \
+        }                                                                                                              \
+        for (; i < n; i++) {                                                                                           \
+            out[i] = a[i] op b[i];                                                                                     \
+        }                                                                                                              \
+    }
+#else
+#define CALCULATOR_SIMD_BINARY_KERNEL(name, op)                                                                        \
+    inline void name(double* out, const double* a, const double* b, size_t n) {                                        \
+        for (size_t i = 0; i < n; i++) {                                                                               \
+            out[i] = a[i] op b[i];                                                                                     \
+        }                                                                                                              \
+    }
+#endif
+
+CALCULATOR_SIMD_BINARY_KERNEL(add, +)
+CALCULATOR_SIMD_BINARY_KERNEL(sub, -)
+CALCULATOR_SIMD_BINARY_KERNEL(mul, *)
+
+#undef CALCULATOR_SIMD_BINARY_KERNEL
+
+/**
+ * @brief Element-wise division that flags zero divisors in @p errorMask instead of throwing
+ */
+inline void divide(double* out, const double* a, const double* b, double* errorMask, size_t n) {
+    size_t i = 0;
+#if defined(CALCULATOR_SIMD_AVX2) || defined(CALCULATOR_SIMD_SSE2)
+    for (; i + kLanes <= n; i += kLanes) {
+        Vec divisor = load(b + i);
+        store(errorMask + i, bitOr(load(errorMask + i), isZero(divisor)));
+        store(out + i, div(load(a + i), divisor));
+    }
+#endif
+    for (; i < n; i++) {
+        orMask(errorMask[i], b[i] == 0);
+        out[i] = a[i] / b[i];
+    }
+}
+
+} // namespace simd
+
+#endif // CALCULATOR_SIMD_KERNELS_H
@@ -0,0 +1,104 @@
+#ifndef CALCULATOR_STATS_RECORDER_H
+#define CALCULATOR_STATS_RECORDER_H
+
+#include "calculator/calculator_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Recording side of calculator_stats, used by the core's hot paths
+ *
+ * Use the CALCULATOR_STATS_* macros rather than calling these functions so that builds without
+ * CALCULATOR_ENABLE_STATS contain no instrumentation at all.
+ */
+namespace calculator_stats {
+namespace detail {
+
+/**
+ * @brief Counters owned by one thread; only that thread writes, snapshot() reads
+ */
+struct ThreadCounters {
+    std::atomic<uint64_t> buckets[static_cast<size_t>(Stage::Count)][Histogram::kBuckets];
+    std::atomic<uint64_t> stageCount[static_cast<size_t>(Stage::Count)];
+    std::atomic<uint64_t> stageNanoseconds[static_cast<size_t>(Stage::Count)];
+    std::atomic<uint64_t> errors[static_cast<size_t>(ErrorKind::Count)];
+    std::atomic<uint64_t> calculations;
+    std::atomic<uint64_t> tokens;
+    std::atomic<uint64_t> maxOperatorStackDepth;
+};
+
+/**
+ * @brief The calling thread's counters, registered on first use
+ */
+ThreadCounters& local();
+
+// Single writer, so a relaxed load/store pair avoids a locked read-modify-write
+inline void add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void recordStage(Stage stage, uint64_t nanoseconds) {
+    size_t bucket = 0;
+    while (bucket + 1 < Histogram::kBuckets && (nanoseconds >> bucket) != 0) {
+        bucket++;
+    }
+    ThreadCounters& counters = local();
+    size_t index = static_cast<size_t>(stage);
+    add(counters.buckets[index][bucket], 1);
+    add(counters.stageCount[index], 1);
+    add(counters.stageNanoseconds[index], nanoseconds);
+}
+
+inline void recordError(ErrorKind kind) { add(local().errors[static_cast<size_t>(kind)], 1); }
+
+inline void recordCalculation(uint64_t tokens) {
+    ThreadCounters& counters = local();
+    add(counters.calculations, 1);
+    add(counters.tokens, tokens);
+}
+
+inline void recordOperatorStackDepth(uint64_t depth) {
+    ThreadCounters& counters = local();
+    if (depth > counters.maxOperatorStackDepth.load(std::memory_order_relaxed)) {
+        counters.maxOperatorStackDepth.store(depth, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Records the lifetime of a scope as one sample of a stage, including when it exits by exception
+ */
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage) : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+    ~StageTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        recordStage(m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace detail
+} // namespace calculator_stats
+
+#if defined(CALCULATOR_ENABLE_STATS) && CALCULATOR_ENABLE_STATS
+#define CALCULATOR_STATS_STAGE(stage)                                                                                  \
+    ::calculator_stats::detail::StageTimer calculatorStageTimer(::calculator_stats::Stage::stage)
+#define CALCULATOR_STATS_ERROR(error) ::calculator_stats::detail::recordError(error)
+#define CALCULATOR_STATS_CALCULATION(tokens) ::calculator_stats::detail::recordCalculation(tokens)
+#define CALCULATOR_STATS_OPERATOR_DEPTH(depth) ::calculator_stats::detail::recordOperatorStackDepth(depth)
+#else
+#define CALCULATOR_STATS_STAGE(stage) ((void)0)
+#define CALCULATOR_STATS_ERROR(error) ((void)0)
+#define CALCULATOR_STATS_CALCULATION(tokens) ((void)0)
+#define CALCULATOR_STATS_OPERATOR_DEPTH(depth) ((void)0)
+#endif
+
+#endif // CALCULATOR_STATS_RECORDER_H
@@ -0,0 +1,88 @@
+#include "calculator/eval_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t kReadChunk = 64 * 1024;
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+} // namespace
+
+EvalClient::EvalClient(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        fail("Cannot create socket");
+    }
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(m_fd);
+        errno = error;
+        fail("Cannot connect to " + socketPath);
+    }
+}
+
+EvalClient::~EvalClient() { ::close(m_fd); }
+
+void EvalClient::send(uint32_t id, std::string_view expression) { eval_protocol::appendRequest(m_out, id, expression); }
+
+void EvalClient::sendRaw(std::string_view bytes) { m_out.append(bytes); }
+
+void EvalClient::flush() {
+    size_t sent = 0;
+    while (sent < m_out.size()) {
+        ssize_t count = ::send(m_fd, m_out.data() + sent, m_out.size() - sent, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail("Cannot send request");
+        }
+        sent += count;
+    }
+    m_out.clear();
+}
+
+bool EvalClient::receive(eval_protocol::Response& response) {
+    flush();
+    while (true) {
+        size_t consumed = 0;
+        auto status =
+            eval_protocol::parseResponse(m_in.data() + m_inStart, m_in.size() - m_inStart, response, consumed);
+        if (status == eval_protocol::ParseStatus::Complete) {
+            m_inStart += consumed;
+            return true;
+        }
+        if (status == eval_protocol::ParseStatus::Invalid) {
+            throw std::runtime_error("Malformed response from server");
+        }
+
+        // Compact before reading so the buffer holds at most one partial frame plus a chunk
+        m_in.erase(0, m_inStart);
+        m_inStart = 0;
+        size_t used = m_in.size();
+        m_in.resize(used + kReadChunk);
+        ssize_t count = ::read(m_fd, &m_in[used], kReadChunk);
+        m_in.resize(used + (count > 0 ? count : 0));
+        if (count == 0) {
+            return false;
+        }
+        if (count < 0 && errno != EINTR) {
+            fail("Cannot read response");
+        }
+    }
+}
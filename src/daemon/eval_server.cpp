@@ -0,0 +1,501 @@
+#include "calculator/eval_server.hpp"
+
+#include "calculator/calculator_core.hpp"
+#include "calculator/eval_protocol.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief A batch of requests from one connection, and then their encoded responses
+ */
+struct EvalServer::Job {
+    struct Slot {
+        uint32_t id;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    /**
+     * @brief Expression bytes at which a batch is handed over even if it has fewer than maxBatch slots
+     * @details Keeps every offset well inside a Slot, and the buffer of a recycled job modest.
+     */
+    static constexpr size_t kMaxBytes = 256 * 1024;
+
+    IoThread* owner = nullptr; // Where the responses go
+    uint64_t connection = 0;
+    std::string expressions; // Expression bytes of every slot, back to back
+    std::vector<Slot> slots;
+    std::string responses;
+
+    void clear() {
+        // One large request can overshoot kMaxBytes; do not keep its buffer in the spare pool for good
+        if (expressions.capacity() > 2 * kMaxBytes) {
+            std::string().swap(expressions);
+        }
+        expressions.clear();
+        slots.clear();
+        responses.clear();
+    }
+};
+
+struct EvalServer::Connection {
+    uint64_t key = 0;
+    int fd = -1;
+    std::string in;          // Received bytes not yet parsed into requests
+    std::string out;         // Encoded responses not yet sent
+    size_t sent = 0;         // Bytes of out already written
+    size_t pending = 0;      // Requests handed to workers and not yet answered
+    size_t pendingBytes = 0; // Expression bytes of those requests
+    uint32_t events = 0;     // Current epoll interest
+    bool readClosed = false;
+    bool failed = false;
+
+    /**
+     * @brief Whether too many requests are unanswered or unsent to take on more
+     */
+    bool saturated() const {
+        return pending >= kMaxPendingRequests || pendingBytes >= kMaxPendingRequestBytes ||
+               out.size() - sent >= kMaxUnsentBytes;
+    }
+
+    /**
+     * @brief Whether to read more requests
+     */
+    bool acceptsInput() const { return !readClosed && !saturated(); }
+};
+
+struct EvalServer::IoThread {
+    int epollFd = -1;
+    int wakeFd = -1; // eventfd the workers signal after queueing a finished batch
+
+    std::mutex completedMutex;
+    std::vector<std::unique_ptr<Job>> completed;
+
+    // Owned by the I/O thread
+    std::unordered_map<uint64_t, Connection> connections;
+    uint64_t nextKey = kFirstConnection;
+    std::vector<std::unique_ptr<Job>> spareJobs; // Recycled so steady-state serving does not allocate
+    std::vector<std::unique_ptr<Job>> draining;
+    std::vector<char> readBuffer = std::vector<char>(kReadChunk);
+
+    std::thread thread;
+
+    // epoll keys; connections are numbered from kFirstConnection and never reuse a key
+    static constexpr uint64_t kListenerKey = 0;
+    static constexpr uint64_t kWakeKey = 1;
+    static constexpr uint64_t kFirstConnection = 2;
+    static constexpr size_t kReadChunk = 64 * 1024;
+};
+
+namespace {
+constexpr int kMaxEvents = 64;
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void wake(int eventFd) {
+    uint64_t one = 1;
+    // A full counter still wakes the reader, so a failed write loses nothing
+    [[maybe_unused]] ssize_t written = ::write(eventFd, &one, sizeof(one));
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+} // namespace
+
+EvalServer::EvalServer(Options options) : m_options(std::move(options)) {
+    m_options.ioThreads = std::max<size_t>(m_options.ioThreads, 1);
+    m_options.maxBatch = std::max<size_t>(m_options.maxBatch, 1);
+    if (m_options.workerThreads == 0) {
+        m_options.workerThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    try {
+        bindListener();
+        for (size_t i = 0; i < m_options.ioThreads; i++) {
+            auto io = std::make_unique<IoThread>();
+            m_ioThreads.push_back(std::move(io));
+            IoThread& thread = *m_ioThreads.back();
+            thread.epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+            thread.wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (thread.epollFd < 0 || thread.wakeFd < 0) {
+                fail("Cannot create event loop");
+            }
+            // Exclusive wakeups, so a new connection wakes one I/O thread rather than all of them
+            epoll_event listen{};
+            listen.events = EPOLLIN | EPOLLEXCLUSIVE;
+            listen.data.u64 = IoThread::kListenerKey;
+            epoll_event wakeup{};
+            wakeup.events = EPOLLIN;
+            wakeup.data.u64 = IoThread::kWakeKey;
+            if (::epoll_ctl(thread.epollFd, EPOLL_CTL_ADD, m_listenFd, &listen) != 0 ||
+                ::epoll_ctl(thread.epollFd, EPOLL_CTL_ADD, thread.wakeFd, &wakeup) != 0) {
+                fail("Cannot create event loop");
+            }
+        }
+        for (size_t i = 0; i < m_options.workerThreads; i++) {
+            m_workers.emplace_back(&EvalServer::workerLoop, this);
+        }
+        for (auto& io : m_ioThreads) {
+            io->thread = std::thread(&EvalServer::ioLoop, this, std::ref(*io));
+        }
+    } catch (...) {
+        stop();
+        throw;
+    }
+}
+
+EvalServer::~EvalServer() { stop(); }
+
+void EvalServer::bindListener() {
+    sockaddr_un address = socketAddress(m_options.socketPath);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fail("Cannot create socket");
+    }
+    auto bindOrThrow = [&] {
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return;
+        }
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        fail("Cannot bind " + m_options.socketPath);
+    };
+
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        if (errno != EADDRINUSE) {
+            bindOrThrow();
+        }
+        // The file exists: take it over only if nobody is accepting on it
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (live) {
+            ::close(fd);
+            throw std::runtime_error("Another server is listening on " + m_options.socketPath);
+        }
+        ::unlink(m_options.socketPath.c_str());
+        bindOrThrow();
+    }
+    if (::listen(fd, SOMAXCONN) != 0) {
+        int error = errno;
+        ::close(fd);
+        ::unlink(m_options.socketPath.c_str());
+        errno = error;
+        fail("Cannot listen on " + m_options.socketPath);
+    }
+    m_listenFd = fd;
+}
+
+void EvalServer::stop() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+    // I/O threads first, so nothing is queued for workers that have exited
+    for (auto& io : m_ioThreads) {
+        if (io->wakeFd >= 0) {
+            wake(io->wakeFd);
+        }
+    }
+    for (auto& io : m_ioThreads) {
+        if (io->thread.joinable()) {
+            io->thread.join();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_workersStopping = true;
+    }
+    m_queueWake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_queue.clear();
+
+    for (auto& io : m_ioThreads) {
+        for (auto& [key, connection] : io->connections) {
+            ::close(connection.fd);
+        }
+        io->connections.clear();
+        if (io->epollFd >= 0) {
+            ::close(io->epollFd);
+        }
+        if (io->wakeFd >= 0) {
+            ::close(io->wakeFd);
+        }
+    }
+    m_ioThreads.clear();
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        ::unlink(m_options.socketPath.c_str());
+        m_listenFd = -1;
+    }
+}
+
+void EvalServer::ioLoop(IoThread& io) {
+    epoll_event events[kMaxEvents];
+    while (!m_stopping.load()) {
+        int count = ::epoll_wait(io.epollFd, events, kMaxEvents, -1);
+        for (int i = 0; i < count; i++) {
+            uint64_t key = events[i].data.u64;
+            if (key == IoThread::kListenerKey) {
+                accept(io);
+                continue;
+            }
+            if (key == IoThread::kWakeKey) {
+                drainCompleted(io);
+                continue;
+            }
+            auto it = io.connections.find(key);
+            if (it == io.connections.end()) {
+                continue;
+            }
+            Connection& connection = it->second;
+            uint32_t ready = events[i].events;
+            if (ready & (EPOLLHUP | EPOLLERR)) {
+                // The peer is gone in both directions, so nobody is left to read responses
+                connection.failed = true;
+            } else {
+                if (ready & EPOLLIN) {
+                    readFrom(io, connection);
+                }
+                if (ready & EPOLLOUT) {
+                    flush(connection);
+                }
+            }
+            settle(io, connection);
+        }
+    }
+}
+
+void EvalServer::accept(IoThread& io) {
+    while (true) {
+        int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN once the backlog is empty; anything else is the client's problem, not the server's
+            return;
+        }
+        uint64_t key = io.nextKey++;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = key;
+        if (::epoll_ctl(io.epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection& connection = io.connections[key];
+        connection.key = key;
+        connection.fd = fd;
+        connection.events = EPOLLIN;
+    }
+}
+
+void EvalServer::readFrom(IoThread& io, Connection& connection) {
+    std::unique_ptr<Job> job;
+    while (connection.acceptsInput()) {
+        ssize_t count = ::read(connection.fd, io.readBuffer.data(), io.readBuffer.size());
+        if (count > 0) {
+            connection.in.append(io.readBuffer.data(), count);
+        } else if (count == 0) {
+            connection.readClosed = true;
+        } else if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            connection.failed = errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+
+        splitFrames(io, connection, job);
+        if (connection.failed) {
+            break;
+        }
+    }
+    if (job) {
+        submit(job);
+    }
+}
+
+void EvalServer::splitFrames(IoThread& io, Connection& connection, std::unique_ptr<Job>& job) {
+    // Split off complete frames until the connection saturates; the rest stays buffered until settle() resumes
+    size_t offset = 0;
+    eval_protocol::Request request;
+    size_t consumed = 0;
+    while (!connection.saturated()) {
+        auto status = eval_protocol::parseRequest(connection.in.data() + offset, connection.in.size() - offset,
+                                                  request, consumed);
+        if (status == eval_protocol::ParseStatus::Incomplete) {
+            break;
+        }
+        if (status == eval_protocol::ParseStatus::Invalid) {
+            connection.failed = true;
+            return;
+        }
+        if (!job) {
+            if (io.spareJobs.empty()) {
+                job = std::make_unique<Job>();
+            } else {
+                job = std::move(io.spareJobs.back());
+                io.spareJobs.pop_back();
+            }
+            job->owner = &io;
+            job->connection = connection.key;
+        }
+        job->slots.push_back({request.id, static_cast<uint32_t>(job->expressions.size()),
+                              static_cast<uint32_t>(request.expression.size())});
+        job->expressions.append(request.expression);
+        connection.pending++;
+        connection.pendingBytes += request.expression.size();
+        offset += consumed;
+        if (job->slots.size() >= m_options.maxBatch || job->expressions.size() >= Job::kMaxBytes) {
+            submit(job);
+        }
+    }
+    connection.in.erase(0, offset);
+}
+
+void EvalServer::submit(std::unique_ptr<Job>& job) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(std::move(job));
+    }
+    m_queueWake.notify_one();
+}
+
+void EvalServer::workerLoop() {
+    CalculatorCore calculator;
+    std::unique_ptr<Job> job;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueWake.wait(lock, [this] { return m_workersStopping || !m_queue.empty(); });
+            if (m_workersStopping) {
+                return;
+            }
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        job->responses.reserve(job->slots.size() * (eval_protocol::kLengthBytes + eval_protocol::kResponsePayload));
+        for (const Job::Slot& slot : job->slots) {
+            std::string_view expression(job->expressions.data() + slot.offset, slot.length);
+            eval_protocol::appendResponse(job->responses, slot.id, calculator.tryCalculate(expression));
+        }
+        m_served.fetch_add(job->slots.size(), std::memory_order_relaxed);
+
+        IoThread& io = *job->owner;
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(io.completedMutex);
+            wasEmpty = io.completed.empty();
+            io.completed.push_back(std::move(job));
+        }
+        // The I/O thread drains everything per wakeup, so only the first batch needs to signal
+        if (wasEmpty) {
+            wake(io.wakeFd);
+        }
+    }
+}
+
+void EvalServer::drainCompleted(IoThread& io) {
+    // Read the counter before taking the batches, so a batch queued after the swap signals again
+    uint64_t counter;
+    [[maybe_unused]] ssize_t drained = ::read(io.wakeFd, &counter, sizeof(counter));
+    {
+        std::lock_guard<std::mutex> lock(io.completedMutex);
+        io.draining.swap(io.completed);
+    }
+    for (auto& job : io.draining) {
+        auto it = io.connections.find(job->connection);
+        if (it != io.connections.end()) {
+            Connection& connection = it->second;
+            connection.out.append(job->responses);
+            connection.pending -= job->slots.size();
+            connection.pendingBytes -= job->expressions.size();
+            flush(connection);
+            settle(io, connection);
+        }
+        job->clear();
+        io.spareJobs.push_back(std::move(job));
+    }
+    io.draining.clear();
+}
+
+void EvalServer::flush(Connection& connection) {
+    while (connection.sent < connection.out.size()) {
+        ssize_t count = ::send(connection.fd, connection.out.data() + connection.sent,
+                               connection.out.size() - connection.sent, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            connection.failed = errno != EAGAIN && errno != EWOULDBLOCK;
+            // Drop what was sent once it outweighs the rest, so a slow reader does not keep it all buffered
+            if (connection.sent > connection.out.size() / 2) {
+                connection.out.erase(0, connection.sent);
+                connection.sent = 0;
+            }
+            return;
+        }
+        connection.sent += count;
+    }
+    connection.out.clear();
+    connection.sent = 0;
+}
+
+void EvalServer::settle(IoThread& io, Connection& connection) {
+    // Frames buffered while the connection was saturated may be the last the client sends, so no read would
+    // come to split them
+    if (!connection.failed && !connection.in.empty() && !connection.saturated()) {
+        std::unique_ptr<Job> job;
+        splitFrames(io, connection, job);
+        if (job) {
+            submit(job);
+        }
+    }
+    bool finished = connection.readClosed && connection.pending == 0 && connection.out.empty();
+    if (connection.failed || finished) {
+        ::epoll_ctl(io.epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        io.connections.erase(connection.key);
+        return;
+    }
+    uint32_t events = 0;
+    if (connection.acceptsInput()) {
+        events |= EPOLLIN;
+    }
+    if (!connection.out.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events != connection.events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = connection.key;
+        ::epoll_ctl(io.epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+}
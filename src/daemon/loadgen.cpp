@@ -0,0 +1,165 @@
+#include "calculator/eval_client.hpp"
+#include "calculator/eval_server.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// A spread of lengths and operators, cycled through by every connection
+constexpr std::string_view kDefaultExpressions[] = {
+    "1+2",
+    "(3.5 - 1.25) * 4 / 2",
+    "2^10 - 3^4 + 5^2",
+    "((1+2)*(3+4) - (5-6)*(7+8)) / 9",
+    "1.5*2.5 + 3.5*4.5 - 5.5/6.5 + 7.5^2",
+    "100 / (1 + (2 * (3 + (4 * (5 + 6)))))",
+};
+
+struct Options {
+    std::string socketPath = "/tmp/calculator.sock";
+    size_t connections = 4;
+    size_t depth = 64;        // Requests kept in flight per connection
+    size_t requests = 100000; // Per connection
+    std::vector<std::string> expressions;
+};
+
+/**
+ * @brief What one connection measured
+ */
+struct ConnectionResult {
+    std::vector<uint32_t> latencies; // Nanoseconds from send to response, capped at UINT32_MAX
+    uint64_t errors = 0;             // Responses carrying an evaluation error
+    std::string failure;             // Set if the connection itself failed
+};
+
+/**
+ * @brief Keep @p depth requests outstanding on one connection until all are answered
+ */
+void runConnection(const Options& options, ConnectionResult& result) {
+    try {
+        EvalClient client(options.socketPath);
+        std::vector<Clock::time_point> sentAt(options.requests);
+        result.latencies.reserve(options.requests);
+
+        size_t sent = 0;
+        size_t received = 0;
+        eval_protocol::Response response;
+        while (received < options.requests) {
+            // Top up the window in one write, then take one response; the rest arrive with the same read
+            Clock::time_point now = Clock::now();
+            while (sent < options.requests && sent - received < options.depth) {
+                sentAt[sent] = now;
+                client.send(static_cast<uint32_t>(sent), options.expressions[sent % options.expressions.size()]);
+                sent++;
+            }
+            if (!client.receive(response)) {
+                result.failure = "server closed the connection";
+                return;
+            }
+            if (response.id >= sent) {
+                result.failure = "response to a request that was never sent";
+                return;
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sentAt[response.id]);
+            result.latencies.push_back(static_cast<uint32_t>(std::min<int64_t>(elapsed.count(), UINT32_MAX)));
+            if (!response.result.ok()) {
+                result.errors++;
+            }
+            received++;
+        }
+    } catch (const std::exception& e) {
+        result.failure = e.what();
+    }
+}
+
+double percentileMicroseconds(const std::vector<uint32_t>& sorted, double fraction) {
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--socket <path>] [--connections <n>] [--depth <n>] [--requests <n>] [--expression <expr>]...\n"
+              << "Drives calculator_daemon and reports throughput and latency percentiles.\n"
+              << "--requests is per connection; --depth is the number of requests in flight per connection,\n"
+              << "at most " << EvalServer::kMaxPendingRequests << ".\n";
+}
+
+bool parseCount(std::string_view text, size_t& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size() && value > 0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--connections" && hasValue && parseCount(argv[i + 1], options.connections)) {
+            i++;
+        } else if (arg == "--depth" && hasValue && parseCount(argv[i + 1], options.depth)) {
+            i++;
+        } else if (arg == "--requests" && hasValue && parseCount(argv[i + 1], options.requests) &&
+                   options.requests <= UINT32_MAX) {
+            i++;
+        } else if (arg == "--expression" && hasValue) {
+            options.expressions.emplace_back(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    // Requests are written without reading, so a deeper window than the server takes in before it stops
+    // reading would leave both sides blocked on full socket buffers
+    if (options.depth > EvalServer::kMaxPendingRequests) {
+        std::cerr << "Note: --depth clamped to " << EvalServer::kMaxPendingRequests << "\n";
+        options.depth = EvalServer::kMaxPendingRequests;
+    }
+    if (options.expressions.empty()) {
+        options.expressions.assign(std::begin(kDefaultExpressions), std::end(kDefaultExpressions));
+    }
+
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (ConnectionResult& result : results) {
+        threads.emplace_back(runConnection, std::cref(options), std::ref(result));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> latencies;
+    uint64_t errors = 0;
+    for (const ConnectionResult& result : results) {
+        if (!result.failure.empty()) {
+            std::cerr << "Error: " << result.failure << "\n";
+            return 1;
+        }
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("requests:   %zu (%llu evaluation errors) over %zu connections, depth %zu\n", latencies.size(),
+                static_cast<unsigned long long>(errors), options.connections, options.depth);
+    std::printf("throughput: %.0f requests/s\n", latencies.size() / seconds);
+    std::printf("latency:    p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+                percentileMicroseconds(latencies, 0.50), percentileMicroseconds(latencies, 0.99),
+                percentileMicroseconds(latencies, 0.999), latencies.back() / 1000.0);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "calculator/eval_server.hpp"
+
+#include <charconv>
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <pthread.h>
+
+namespace {
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--socket <path>] [--io-threads <n>] [--workers <n>] [--batch <n>]\n"
+              << "Serves expression evaluation on a Unix domain socket until interrupted.\n";
+}
+
+bool parseCount(std::string_view text, size_t& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    EvalServer::Options options;
+    options.socketPath = "/tmp/calculator.sock";
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--io-threads" && hasValue && parseCount(argv[i + 1], options.ioThreads)) {
+            i++;
+        } else if (arg == "--workers" && hasValue && parseCount(argv[i + 1], options.workerThreads)) {
+            i++;
+        } else if (arg == "--batch" && hasValue && parseCount(argv[i + 1], options.maxBatch)) {
+            i++;
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    // Block the shutdown signals before any thread starts, so they all inherit the mask and sigwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        EvalServer server(options);
+        std::cerr << "Listening on " << options.socketPath << "\n";
+        int received = 0;
+        sigwait(&signals, &received);
+        server.stop();
+        std::cerr << "Served " << server.requestsServed() << " requests\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,11 +1,14 @@
 #include "calculator/calculator_gui.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include "glad.h"
 
@@ -20,11 +23,98 @@ namespace {
 void glfw_error_callback(int error, const char* description) {
     std::cerr << "GLFW Error " << error << ": " << description << '\n';
 }
+
+std::string formatResult(double value) {
+    std::ostringstream oss;
+    double intpart;
+    if (std::modf(value, &intpart) == 0.0) {
+        // Whole number
+        oss << std::setprecision(0) << std::fixed << value;
+        return oss.str();
+    }
+    // Decimal number - show up to 10 significant digits
+    oss << std::setprecision(10) << value;
+    auto str = oss.str();
+    // Trim trailing zeros
+    str.erase(str.find_last_not_of('0') + 1, std::string::npos);
+    if (str.back() == '.')
+        str.pop_back();
+    return str;
+}
+
+// Built once; render() only walks it
+constexpr std::array<std::array<std::string_view, 5>, 5> kButtons = {{{"7", "8", "9", "/", "^"},
+                                                                      {"4", "5", "6", "*", "("},
+                                                                      {"1", "2", "3", "-", ")"},
+                                                                      {"0", ".", "=", "+", "C"},
+                                                                      {"x", "M+", "MR", "MC", ""}}};
+
+// Height of the history list, and the window height that leaves room for it under the keypad
+constexpr float kHistoryHeight = 160.0f;
+constexpr int kHistoryWindowHeight = 590;
+
+// Window height that leaves room for the plot under the keypad
+constexpr int kPlotWindowHeight = 760;
+
+// Zoom per mouse wheel step
+constexpr double kPlotZoomStep = 0.9;
+
+// Seconds to average loop timing over before the overlay updates
+constexpr double kFrameStatsWindow = 1.0;
+
+/**
+ * @brief Where the history log lives: $CALCULATOR_HISTORY, else ~/.calculator_history; empty if neither is set
+ */
+std::string historyPath() {
+    if (const char* path = std::getenv("CALCULATOR_HISTORY")) {
+        return path;
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return std::string(home) + "/.calculator_history";
+    }
+    return {};
+}
+
+void scheduleRedraw(GLFWwindow* window) { static_cast<CalculatorGUI*>(glfwGetWindowUserPointer(window))->requestRedraw(); }
+
+/**
+ * @brief Wake the render loop on any input or window change
+ * @details Installed before the ImGui backend, which chains to these from its own callbacks.
+ */
+void installRedrawCallbacks(GLFWwindow* window) {
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) { scheduleRedraw(w); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) { scheduleRedraw(w); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { scheduleRedraw(w); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int) { scheduleRedraw(w); });
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { scheduleRedraw(w); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) { scheduleRedraw(w); });
+    glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) { scheduleRedraw(w); });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { scheduleRedraw(w); });
+    glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int) { scheduleRedraw(w); });
+}
 } // namespace
 
-CalculatorGUI::CalculatorGUI() : m_calculator_core(std::make_unique<CalculatorCore>()) {}
+// Posting an empty event wakes run() from glfwWaitEvents to pick up the result
+CalculatorGUI::CalculatorGUI()
+    : m_calculator_core(std::make_unique<CalculatorCore>()),
+      m_evaluator(std::make_unique<AsyncEvaluator>([] { glfwPostEmptyEvent(); })) {
+    m_preview.push(m_displayBuffer);
+
+    // History is a convenience: without it the calculator still works, it just forgets
+    std::string path = historyPath();
+    if (!path.empty()) {
+        try {
+            m_history = std::make_unique<HistoryLog>(path);
+            m_calculator_core->storeInMemory(m_history->memory());
+        } catch (const std::runtime_error& e) {
+            std::cerr << "History disabled: " << e.what() << '\n';
+        }
+    }
+}
 
 CalculatorGUI::~CalculatorGUI() {
+    // Stop the worker first, since it posts GLFW events
+    m_evaluator.reset();
     if (ImGui::GetCurrentContext()) {
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
@@ -60,6 +150,9 @@ bool CalculatorGUI::initialize() {
         return false;
     }
 
+    glfwSetWindowUserPointer(m_window, this);
+    installRedrawCallbacks(m_window);
+
     glfwMakeContextCurrent(m_window);
     glfwSwapInterval(1); // Enable vsync
 
@@ -97,8 +190,22 @@ bool CalculatorGUI::initialize() {
 }
 
 void CalculatorGUI::run() {
+    m_frameStats.windowStart = glfwGetTime();
     while (!glfwWindowShouldClose(m_window)) {
-        glfwPollEvents();
+        if (m_pendingFrames == 0) {
+            // Nothing changed since the last frame: sleep until a callback or glfwPostEmptyEvent wakes us
+            double waitStart = glfwGetTime();
+            glfwWaitEvents();
+            m_frameStats.windowIdle += glfwGetTime() - waitStart;
+        } else {
+            glfwPollEvents();
+        }
+        pollEvaluation();
+        if (m_pendingFrames == 0) {
+            continue;
+        }
+        m_pendingFrames--;
+        double frameStart = glfwGetTime();
 
         // Start the ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -116,11 +223,37 @@ void CalculatorGUI::run() {
         glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        recordFrame(glfwGetTime() - frameStart);
 
         glfwSwapBuffers(m_window);
     }
 }
 
+void CalculatorGUI::requestRedraw() { m_pendingFrames = kFramesPerEvent; }
+
+void CalculatorGUI::setFrameStatsVisible(bool visible) {
+    m_showFrameStats = visible;
+    requestRedraw();
+}
+
+void CalculatorGUI::recordFrame(double busySeconds) {
+    FrameStats& stats = m_frameStats;
+    stats.redraws++;
+    stats.windowFrames++;
+    stats.windowBusy += busySeconds;
+
+    double now = glfwGetTime();
+    double elapsed = now - stats.windowStart;
+    if (elapsed >= kFrameStatsWindow) {
+        stats.frameMilliseconds = stats.windowBusy / stats.windowFrames * 1000.0;
+        stats.idlePercent = stats.windowIdle / elapsed * 100.0;
+        stats.windowStart = now;
+        stats.windowIdle = 0.0;
+        stats.windowBusy = 0.0;
+        stats.windowFrames = 0;
+    }
+}
+
 void CalculatorGUI::render() {
     // Get window size
     int width, height;
@@ -138,23 +271,31 @@ void CalculatorGUI::render() {
 
     // Display buffer
     ImGui::InputText("Display", &m_displayBuffer, ImGuiInputTextFlags_ReadOnly);
+    renderPreview();
 
-    // Button layout
-    const std::array<std::array<std::string, 5>, 4> buttons = {
-        {{"7", "8", "9", "/", "^"}, {"4", "5", "6", "*", "("}, {"1", "2", "3", "-", ")"}, {"0", ".", "=", "+", "C"}}};
+    if (ImGui::IsWindowFocused() && ImGui::IsKeyPressed(ImGuiKey_Backspace) && !m_displayBuffer.empty()) {
+        m_evaluator->cancel();
+        m_displayBuffer.pop_back();
+        m_preview.pop();
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_F12, false)) {
+        m_showFrameStats = !m_showFrameStats;
+    }
 
+    // Button layout
     float available_width = ImGui::GetContentRegionAvail().x;
     float spacing = ImGui::GetStyle().ItemSpacing.x;
-    int columns = buttons[0].size();
+    int columns = kButtons[0].size();
     float button_width = (available_width - (columns - 1) * spacing) / columns;
     float button_height = 50.0f;
 
-    for (const auto& row : buttons) {
+    for (const auto& row : kButtons) {
         ImGui::BeginGroup();
         for (size_t i = 0; i < row.size(); i++) {
             const auto& label = row[i];
             if (!label.empty()) {
-                if (ImGui::Button(label.c_str(), ImVec2(button_width, button_height))) {
+                // Labels are string literals, so data() is null-terminated
+                if (ImGui::Button(label.data(), ImVec2(button_width, button_height))) {
                     processButtonClick(label);
                 }
                 if (i < row.size() - 1) {
@@ -165,41 +306,280 @@ void CalculatorGUI::render() {
         ImGui::EndGroup();
     }
 
+    if (m_history) {
+        if (ImGui::Checkbox("History", &m_historyVisible) && m_historyVisible && height < kHistoryWindowHeight) {
+            glfwSetWindowSize(m_window, width, kHistoryWindowHeight);
+        }
+        ImGui::SameLine();
+    }
+    if (ImGui::Checkbox("Plot", &m_plotVisible) && m_plotVisible && height < kPlotWindowHeight) {
+        glfwSetWindowSize(m_window, width, kPlotWindowHeight);
+    }
+    if (m_historyVisible && m_history) {
+        renderHistory();
+    }
+    if (m_plotVisible) {
+        renderPlot();
+    }
+
     ImGui::End();
+
+    if (m_showFrameStats) {
+        renderFrameStats();
+    }
 }
 
-void CalculatorGUI::processButtonClick(const std::string& label) {
-    if (label == "=") {
+void CalculatorGUI::pollEvaluation() {
+    CalcResult result;
+    if (!m_evaluator->poll(result)) {
+        return;
+    }
+    if (m_history) {
         try {
-            m_result = m_calculator_core->calculate(m_displayBuffer);
-
-            // Format the output
-            std::ostringstream oss;
-            double intpart;
-            if (std::modf(m_result, &intpart) == 0.0) {
-                // Whole number
-                oss << std::setprecision(0) << std::fixed << m_result;
+            m_history->append(m_pendingExpression, result);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "History disabled: " << e.what() << '\n';
+            m_history.reset();
+        }
+    }
+    if (result.ok()) {
+        m_result = result.value;
+        m_displayBuffer = formatResult(m_result);
+    } else {
+        m_displayBuffer = "Error";
+    }
+    m_preview.assign(m_displayBuffer);
+    requestRedraw();
+}
+
+void CalculatorGUI::renderHistory() {
+    if (!ImGui::BeginChild("History", ImVec2(0.0f, kHistoryHeight), true)) {
+        ImGui::EndChild();
+        return;
+    }
+    // Only the visible rows are read from the log, so its length does not affect frame time
+    const size_t count = m_history->size();
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(std::min<size_t>(count, INT32_MAX)));
+    std::string label;
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            HistoryLog::Entry entry = (*m_history)[count - 1 - row];
+            label.assign(entry.expression);
+            if (entry.error == CalcError::None) {
+                label += " = " + formatResult(entry.value);
             } else {
-                // Decimal number - show up to 10 significant digits
-                oss << std::setprecision(10) << m_result;
-                auto str = oss.str();
-                // Trim trailing zeros
-                str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-                if (str.back() == '.')
-                    str.pop_back();
-                m_displayBuffer = str;
-                return;
+                label += " : ";
+                label += errorName(entry.error);
+            }
+            ImGui::PushID(row);
+            if (ImGui::Selectable(label.c_str())) {
+                m_evaluator->cancel();
+                m_displayBuffer.assign(entry.expression);
+                m_preview.assign(m_displayBuffer);
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+}
+
+void CalculatorGUI::renderPlot() {
+    // Recompile only when the buffer changes; tiles cached by the old sampler are for a different function
+    if (m_displayBuffer != m_plotExpression) {
+        m_plotExpression = m_displayBuffer;
+        m_plotError.clear();
+        m_sampler.reset();
+        try {
+            CompiledExpression compiled = m_calculator_core->compile(m_plotExpression);
+            if (!compiled.variables().empty() && compiled.variables()[0] != "x") {
+                throw std::runtime_error("Unbound variable: " + compiled.variables()[0]);
+            }
+            m_sampler = std::make_unique<FunctionSampler>(std::move(compiled));
+        } catch (const std::runtime_error& e) {
+            m_plotError = e.what();
+        }
+    }
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImGui::GetContentRegionAvail();
+    if (size.x < 16.0f || size.y < 16.0f) {
+        return;
+    }
+    ImGui::InvisibleButton("plot", size);
+
+    // Drag to pan, scroll to zoom about the cursor
+    PlotView& view = m_plotView;
+    double xPerPixel = (view.xMax - view.xMin) / size.x;
+    double yPerPixel = (view.yMax - view.yMin) / size.y;
+    if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+        ImVec2 delta = ImGui::GetMouseDragDelta(ImGuiMouseButton_Left);
+        ImGui::ResetMouseDragDelta(ImGuiMouseButton_Left);
+        view.xMin -= delta.x * xPerPixel;
+        view.xMax -= delta.x * xPerPixel;
+        view.yMin += delta.y * yPerPixel;
+        view.yMax += delta.y * yPerPixel;
+    }
+    const ImGuiIO& io = ImGui::GetIO();
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+        double factor = std::pow(kPlotZoomStep, io.MouseWheel);
+        double mouseX = view.xMin + (io.MousePos.x - origin.x) * xPerPixel;
+        double mouseY = view.yMax - (io.MousePos.y - origin.y) * yPerPixel;
+        view.xMin = mouseX + (view.xMin - mouseX) * factor;
+        view.xMax = mouseX + (view.xMax - mouseX) * factor;
+        view.yMin = mouseY + (view.yMin - mouseY) * factor;
+        view.yMax = mouseY + (view.yMax - mouseY) * factor;
+    }
+    xPerPixel = (view.xMax - view.xMin) / size.x;
+    yPerPixel = (view.yMax - view.yMin) / size.y;
+    auto toScreen = [&](double x, double y) {
+        return ImVec2(static_cast<float>(origin.x + (x - view.xMin) / xPerPixel),
+                      static_cast<float>(origin.y + (view.yMax - y) / yPerPixel));
+    };
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 corner(origin.x + size.x, origin.y + size.y);
+    drawList->AddRectFilled(origin, corner, IM_COL32(20, 22, 26, 255));
+    drawList->PushClipRect(origin, corner, true);
+
+    const ImU32 axisColor = IM_COL32(90, 90, 90, 255);
+    if (view.xMin < 0.0 && view.xMax > 0.0) {
+        drawList->AddLine(toScreen(0.0, view.yMin), toScreen(0.0, view.yMax), axisColor);
+    }
+    if (view.yMin < 0.0 && view.yMax > 0.0) {
+        drawList->AddLine(toScreen(view.xMin, 0.0), toScreen(view.xMax, 0.0), axisColor);
+    }
+
+    if (m_sampler) {
+        m_sampler->sample(view.xMin, view.xMax, static_cast<size_t>(size.x), m_plotPoints);
+
+        // Break the curve at failed samples, and where it leaves the view on one side and comes back on the
+        // other, which is a pole rather than something to connect
+        const ImU32 curveColor = IM_COL32(255, 200, 60, 255);
+        const double margin = view.yMax - view.yMin;
+        auto flush = [&] {
+            if (m_plotLine.size() >= 2) {
+                drawList->AddPolyline(m_plotLine.data(), static_cast<int>(m_plotLine.size()), curveColor, 0, 1.5f);
+            }
+            m_plotLine.clear();
+        };
+        int lastSide = 0;
+        for (const FunctionSampler::Point& point : m_plotPoints) {
+            if (!std::isfinite(point.y)) {
+                flush();
+                lastSide = 0;
+                continue;
+            }
+            int side = point.y > view.yMax ? 1 : point.y < view.yMin ? -1 : 0;
+            if (side != 0 && side == -lastSide) {
+                flush();
             }
-            m_displayBuffer = oss.str();
-        } catch (const std::exception& e) {
-            m_displayBuffer = "Error";
+            lastSide = side;
+            // Clamp far-off values so screen coordinates stay within float range
+            m_plotLine.push_back(toScreen(point.x, std::clamp(point.y, view.yMin - margin, view.yMax + margin)));
         }
-    } else if (label == "C") {
+        flush();
+    }
+    drawList->PopClipRect();
+
+    if (!m_plotError.empty()) {
+        drawList->AddText(ImVec2(origin.x + 6.0f, origin.y + 6.0f), IM_COL32(255, 110, 110, 255), m_plotError.c_str());
+    }
+}
+
+void CalculatorGUI::renderFrameStats() {
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImVec2 corner(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + viewport->WorkSize.y - 10.0f);
+    ImGui::SetNextWindowPos(corner, ImGuiCond_Always, ImVec2(1.0f, 1.0f));
+    ImGui::SetNextWindowBgAlpha(0.6f);
+
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                             ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                             ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
+    if (ImGui::Begin("Frame stats", nullptr, flags)) {
+        ImGui::Text("Frame: %.2f ms", m_frameStats.frameMilliseconds);
+        ImGui::Text("Idle: %.1f%%", m_frameStats.idlePercent);
+        ImGui::Text("Redraws: %llu", static_cast<unsigned long long>(m_frameStats.redraws));
+    }
+    ImGui::End();
+}
+
+void CalculatorGUI::renderPreview() {
+    if (m_evaluator->busy()) {
+        ImGui::TextDisabled("Computing...");
+        return;
+    }
+    IncrementalEvaluator::Preview preview = m_preview.preview();
+    switch (preview.status) {
+    case IncrementalEvaluator::Preview::Empty:
+        ImGui::TextDisabled(" ");
+        break;
+    case IncrementalEvaluator::Preview::Complete:
+        ImGui::Text("= %s", formatResult(preview.value).c_str());
+        break;
+    case IncrementalEvaluator::Preview::Partial:
+        // Mid-entry: show what the complete part evaluates to, dimmed
+        if (preview.hasValue) {
+            ImGui::TextDisabled("= %s ...", formatResult(preview.value).c_str());
+        } else {
+            ImGui::TextDisabled("...");
+        }
+        break;
+    case IncrementalEvaluator::Preview::Invalid:
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s",
+                           formatError(preview.error, m_preview.text()).c_str());
+        break;
+    }
+}
+
+void CalculatorGUI::processButtonClick(std::string_view label) {
+    if (label == "=") {
+        // pollEvaluation() shows the result; pressing '=' again restarts the evaluation
+        m_pendingExpression = m_displayBuffer;
+        m_evaluator->submit(m_displayBuffer);
+        return;
+    }
+    // M+ and MC leave the buffer alone, so a pending result stays valid
+    if (label == "M+") {
+        IncrementalEvaluator::Preview preview = m_preview.preview();
+        if (preview.status == IncrementalEvaluator::Preview::Complete) {
+            storeMemory(m_calculator_core->recallMemory() + preview.value);
+        }
+        return;
+    }
+    if (label == "MC") {
+        storeMemory(0.0);
+        return;
+    }
+
+    // Any edit makes a pending result stale
+    m_evaluator->cancel();
+    if (label == "C") {
         m_displayBuffer.clear();
+        m_preview.clear();
+    } else if (label == "MR") {
+        if (m_displayBuffer == "0") {
+            m_displayBuffer.clear();
+            m_preview.clear();
+        }
+        // Parenthesize negatives so recalling after an operator stays a valid expression
+        double memory = m_calculator_core->recallMemory();
+        std::string recalled = memory < 0.0 ? "(" + formatResult(memory) + ")" : formatResult(memory);
+        m_displayBuffer += recalled;
+        m_preview.push(recalled);
     } else {
         if (m_displayBuffer == "0") {
             m_displayBuffer.clear();
+            m_preview.clear();
         }
         m_displayBuffer += label;
+        m_preview.push(label);
+    }
+}
+
+void CalculatorGUI::storeMemory(double value) {
+    m_calculator_core->storeInMemory(value);
+    if (m_history) {
+        m_history->setMemory(value);
     }
 }
@@ -1,8 +1,9 @@
 #include "calculator/calculator_gui.hpp"
 
 #include <iostream>
+#include <string_view>
 
-int main() {
+int main(int argc, char** argv) {
     try {
         CalculatorGUI gui;
         if (!gui.initialize()) {
@@ -10,6 +11,15 @@ int main() {
             return 1;
         }
 
+        for (int i = 1; i < argc; i++) {
+            if (std::string_view(argv[i]) == "--frame-stats") {
+                gui.setFrameStatsVisible(true);
+            } else {
+                std::cerr << "Unknown option: " << argv[i] << "\n";
+                return 1;
+            }
+        }
+
         // Run the main loop
         gui.run();
 
@@ -0,0 +1,22 @@
+// Each MALFORMED_CASE must fail to compile; see the ConstexprRejects tests in CMakeLists.txt
+#include "calculator/constexpr_expression.hpp"
+
+#if MALFORMED_CASE == 0
+constexpr double kValue = CALCULATOR_CONSTANT("1 +");
+#elif MALFORMED_CASE == 1
+constexpr double kValue = CALCULATOR_CONSTANT("(1 + 2");
+#elif MALFORMED_CASE == 2
+constexpr double kValue = CALCULATOR_CONSTANT("1.2.3");
+#elif MALFORMED_CASE == 3
+constexpr double kValue = CALCULATOR_CONSTANT("2 $ 3");
+#elif MALFORMED_CASE == 4
+constexpr double kValue = CALCULATOR_CONSTANT("4 / (2 - 2)");
+#elif MALFORMED_CASE == 5
+constexpr double kValue = CALCULATOR_CONSTANT("x + 1");
+#elif MALFORMED_CASE == 6
+const double kValue = CALCULATOR_FORMULA("2 3 * x").evaluate(1.0);
+#else
+const double kValue = CALCULATOR_FORMULA("sqrt(x) + 1").evaluate(4.0);
+#endif
+
+int main() { return kValue > 0; }
@@ -0,0 +1,99 @@
+#include "calculator/calculator_core.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <gtest/gtest.h>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+} // namespace
+
+// Count every global allocation made by this test binary
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+size_t allocationsDuring(CalculatorCore& calc, const std::string& expression, int iterations) {
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    for (int i = 0; i < iterations; i++) {
+        calc.calculate(expression);
+    }
+    return g_allocations.load(std::memory_order_relaxed) - before;
+}
+} // namespace
+
+TEST(AllocationTest, CalculateDoesNotAllocateInSteadyState) {
+    CalculatorCore calc;
+    const std::string expression = "(1.5 + 2.25) * -3 / (4 - 0.5) ^ 2 + 10 - 7 * 8";
+
+    // The first call sizes the scratch buffers
+    calc.calculate(expression);
+
+    EXPECT_EQ(allocationsDuring(calc, expression, 1000), 0u);
+}
+
+TEST(AllocationTest, ShorterExpressionsReuseScratch) {
+    CalculatorCore calc;
+    calc.calculate("1+2+3+4+5+6+7+8+9+10+11+12+13+14+15+16");
+
+    EXPECT_EQ(allocationsDuring(calc, "2*(3+4)", 100), 0u);
+    EXPECT_EQ(allocationsDuring(calc, "-1+-1", 100), 0u);
+}
+
+TEST(AllocationTest, TryCalculateErrorsDoNotAllocate) {
+    CalculatorCore calc;
+    calc.calculate("(1 + 2) * 3 - 4 / 5");
+
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    for (const char* expression : {"1/0", "(1+2", "1+$", "1 2", "1.2.3", "1+"}) {
+        EXPECT_FALSE(calc.tryCalculate(expression).ok());
+    }
+    EXPECT_EQ(g_allocations.load(std::memory_order_relaxed) - before, 0u);
+}
+
+TEST(AllocationTest, ScratchAboveLimitIsReleased) {
+    CalculatorCore calc;
+    calc.calculate("1+2*3");
+    EXPECT_GT(calc.scratchBytes(), 0u);
+
+    calc.setScratchLimit(4096);
+    std::string huge = "1";
+    for (int i = 0; i < 10000; i++) {
+        huge += "+1";
+    }
+    EXPECT_EQ(calc.calculate(huge), 10001);
+    EXPECT_EQ(calc.scratchBytes(), 0u);
+
+    // Small expressions regrow within the limit and are allocation-free again
+    calc.calculate("(1.5 + 2) * 3");
+    EXPECT_GT(calc.scratchBytes(), 0u);
+    EXPECT_LE(calc.scratchBytes(), 4096u);
+    EXPECT_EQ(allocationsDuring(calc, "(1.5 + 2) * 3", 100), 0u);
+}
+
+TEST(AllocationTest, DefaultLimitKeepsLargeScratch) {
+    CalculatorCore calc;
+    std::string expression = "1";
+    for (int i = 0; i < 1000; i++) {
+        expression += "*1";
+    }
+    calc.calculate(expression);
+    EXPECT_LE(calc.scratchBytes(), CalculatorCore::kDefaultScratchLimit);
+    EXPECT_EQ(allocationsDuring(calc, expression, 10), 0u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
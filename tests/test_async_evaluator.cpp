@@ -0,0 +1,122 @@
+#include "calculator/async_evaluator.hpp"
+#include "calculator/calculator_core.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+bool waitForResult(AsyncEvaluator& evaluator, CalcResult& result) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (evaluator.poll(result)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+std::string longSum(size_t terms) {
+    std::string expression = "1";
+    expression.reserve(terms * 2);
+    for (size_t i = 1; i < terms; i++) {
+        expression += "+1";
+    }
+    return expression;
+}
+} // namespace
+
+TEST(CancellationTest, SetFlagStopsEveryEngine) {
+    std::atomic<bool> cancel{true};
+    for (auto engine : {CalculatorCore::Engine::ShuntingYard, CalculatorCore::Engine::Pratt}) {
+        CalculatorCore calc;
+        calc.setEngine(engine);
+        calc.setCancellationFlag(&cancel);
+        EXPECT_EQ(calc.tryCalculate(longSum(10000)).error, CalcError::Cancelled);
+        EXPECT_THROW(calc.calculate("1+2"), std::runtime_error);
+
+        cancel.store(false);
+        EXPECT_EQ(calc.calculate(longSum(10000)), 10000);
+        calc.setCancellationFlag(nullptr);
+        cancel.store(true);
+        EXPECT_EQ(calc.calculate("1+2"), 3);
+    }
+}
+
+TEST(CancellationTest, StopsParenthesizedSumMidEvaluation) {
+    // After the '(' every operand starts at an odd token count, so polling must not key on that count
+    std::string expression = "(" + longSum(10000000) + ")";
+    for (auto engine : {CalculatorCore::Engine::ShuntingYard, CalculatorCore::Engine::Pratt}) {
+        std::atomic<bool> cancel{false};
+        CalculatorCore calc;
+        calc.setEngine(engine);
+        calc.setCancellationFlag(&cancel);
+        std::thread canceller([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            cancel.store(true);
+        });
+        CalcResult result = calc.tryCalculate(expression);
+        canceller.join();
+        EXPECT_EQ(result.error, CalcError::Cancelled);
+    }
+}
+
+TEST(AsyncEvaluatorTest, DeliversResults) {
+    std::atomic<int> notifications{0};
+    AsyncEvaluator evaluator([&] { notifications++; });
+    EXPECT_FALSE(evaluator.busy());
+
+    CalcResult result;
+    evaluator.submit("(1 + 2) * 3");
+    EXPECT_TRUE(evaluator.busy());
+    ASSERT_TRUE(waitForResult(evaluator, result));
+    EXPECT_FALSE(evaluator.busy());
+    EXPECT_EQ(result.value, 9);
+
+    evaluator.submit("1/0");
+    ASSERT_TRUE(waitForResult(evaluator, result));
+    EXPECT_EQ(result.error, CalcError::DivisionByZero);
+    EXPECT_EQ(notifications.load(), 2);
+}
+
+TEST(AsyncEvaluatorTest, NewSubmissionSupersedesOld) {
+    AsyncEvaluator evaluator;
+    CalcResult result;
+    for (int i = 0; i < 20; i++) {
+        evaluator.submit(longSum(1000000));
+        evaluator.submit(std::to_string(i) + "*2");
+        ASSERT_TRUE(waitForResult(evaluator, result));
+        EXPECT_EQ(result.value, i * 2);
+    }
+}
+
+TEST(AsyncEvaluatorTest, CancelDiscardsResult) {
+    AsyncEvaluator evaluator;
+    evaluator.submit(longSum(1000000));
+    evaluator.cancel();
+    EXPECT_FALSE(evaluator.busy());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CalcResult result;
+    EXPECT_FALSE(evaluator.poll(result));
+
+    // Still usable afterwards
+    evaluator.submit("2^10");
+    ASSERT_TRUE(waitForResult(evaluator, result));
+    EXPECT_EQ(result.value, 1024);
+}
+
+TEST(AsyncEvaluatorTest, DestroyWhileBusy) {
+    auto start = std::chrono::steady_clock::now();
+    {
+        AsyncEvaluator evaluator;
+        evaluator.submit(longSum(5000000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // Cancellation stops the evaluation rather than waiting for it to finish
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
@@ -0,0 +1,49 @@
+#include "calculator/batch_calculator.hpp"
+#include "calculator/calculator_core.hpp"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(BatchCalculatorTest, ResultsAreInInputOrder) {
+    BatchCalculator batch(4);
+    ASSERT_EQ(batch.threadCount(), 4u);
+
+    std::vector<std::string> expressions;
+    for (int i = 0; i < 1000; i++) {
+        expressions.push_back(std::to_string(i) + "*2+1");
+    }
+
+    auto results = batch.calculate(expressions);
+    ASSERT_EQ(results.size(), expressions.size());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(results[i].ok()) << results[i].error;
+        EXPECT_EQ(results[i].value, i * 2 + 1);
+    }
+}
+
+TEST(BatchCalculatorTest, ErrorsArePerItem) {
+    BatchCalculator batch(2);
+    auto results = batch.calculate({"1+1", "1/0", "(2", "3^2", "2$"});
+
+    ASSERT_EQ(results.size(), 5u);
+    EXPECT_EQ(results[0].value, 2);
+    EXPECT_EQ(results[1].error, "Division by zero");
+    EXPECT_EQ(results[2].error, "Mismatched parentheses");
+    EXPECT_EQ(results[3].value, 9);
+    EXPECT_FALSE(results[4].ok());
+}
+
+TEST(BatchCalculatorTest, PoolIsReusable) {
+    BatchCalculator batch;
+    CalculatorCore calc;
+    EXPECT_TRUE(batch.calculate({}).empty());
+    for (int round = 0; round < 20; round++) {
+        std::vector<std::string> expressions(round * 37 + 1, "(" + std::to_string(round) + "+1)*-3");
+        auto results = batch.calculate(expressions);
+        for (const auto& result : results) {
+            ASSERT_EQ(result.value, calc.calculate(expressions[0]));
+        }
+    }
+}
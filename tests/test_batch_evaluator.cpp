@@ -0,0 +1,53 @@
+#include "calculator/batch_evaluator.hpp"
+#include "calculator/calculator_core.hpp"
+
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+class BatchEvaluatorTest : public ::testing::Test {
+protected:
+    CalculatorCore calc;
+};
+
+TEST_F(BatchEvaluatorTest, MatchesScalarEvaluation) {
+    auto expr = calc.compile("(x + 1.5) * -y - x / (y + 100) + 2 ^ (x / 4)");
+
+    // Use a row count that is not a multiple of the block size or the vector width
+    const size_t rows = 3 * BatchEvaluator::kBlockSize + 7;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::vector<double> xs(rows), ys(rows);
+    for (size_t i = 0; i < rows; i++) {
+        xs[i] = dist(rng);
+        ys[i] = dist(rng);
+    }
+
+    BatchEvaluator batch(expr);
+    auto results = batch.evaluate({xs, ys});
+    ASSERT_EQ(results.size(), rows);
+    for (size_t i = 0; i < rows; i++) {
+        EXPECT_DOUBLE_EQ(results[i], expr.evaluate({xs[i], ys[i]})) << "row " << i;
+    }
+}
+
+TEST_F(BatchEvaluatorTest, DivisionByZeroIsReportedPerRow) {
+    BatchEvaluator batch(calc.compile("1 / (1 / x) + 1"));
+    std::vector<double> xs = {1, 0, 2, -0.0, 4, 0, 8};
+    std::vector<unsigned char> errors;
+
+    auto results = batch.evaluate({xs}, &errors);
+    ASSERT_EQ(errors, (std::vector<unsigned char>{0, 1, 0, 1, 0, 1, 0}));
+    EXPECT_EQ(results[0], 2);
+    EXPECT_EQ(results[2], 3);
+    EXPECT_EQ(results[6], 9);
+    EXPECT_TRUE(std::isnan(results[1]));
+}
+
+TEST_F(BatchEvaluatorTest, ConstantsAndLoneVariables) {
+    std::vector<double> xs = {1, 2, 3};
+    EXPECT_EQ(BatchEvaluator(calc.compile("x")).evaluate({xs}), xs);
+    EXPECT_EQ(BatchEvaluator(calc.compile("2^3")).evaluate({}), std::vector<double>{8});
+    EXPECT_THROW(BatchEvaluator(calc.compile("x+y")).evaluate({xs}), std::runtime_error);
+}
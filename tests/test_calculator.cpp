@@ -48,6 +48,64 @@ TEST_F(CalculatorTest, Divide) {
     EXPECT_THROW(calc.calculate("1/0"), std::runtime_error);
 }
 
+TEST_F(CalculatorTest, InvalidNumbers) {
+    EXPECT_EQ(calc.calculate(".5+5."), 5.5);
+    EXPECT_THROW(calc.calculate("1.2.3"), std::runtime_error);
+    EXPECT_THROW(calc.calculate("."), std::runtime_error);
+}
+
+TEST_F(CalculatorTest, TryCalculateReportsErrorPositions) {
+    auto ok = calc.tryCalculate("2*(3+4)");
+    ASSERT_TRUE(ok.ok());
+    EXPECT_EQ(ok.value, 14);
+
+    struct Case {
+        const char* expression;
+        CalcError error;
+        uint32_t position;
+    };
+    for (const auto& c : {Case{"1 + 2 $ 3", CalcError::InvalidCharacter, 6},
+                          Case{"1 + 1.2.3", CalcError::InvalidNumber, 4},
+                          Case{"(1 + 2", CalcError::MismatchedParentheses, 0},
+                          Case{"1 + 2)", CalcError::MismatchedParentheses, 5},
+                          Case{"1 + * 2", CalcError::NotEnoughOperands, 4},
+                          Case{"1 +", CalcError::NotEnoughOperands, 3},
+                          Case{"1 2", CalcError::TooManyOperands, 2},
+                          Case{"4 / (2 - 2)", CalcError::DivisionByZero, 2},
+                          Case{"1 + x", CalcError::UnboundVariable, 4},
+                          Case{"   ", CalcError::EmptyExpression, 0}}) {
+        auto result = calc.tryCalculate(c.expression);
+        EXPECT_EQ(result.error, c.error) << c.expression;
+        EXPECT_EQ(result.position, c.position) << c.expression;
+    }
+}
+
+TEST_F(CalculatorTest, CalculateKeepsErrorMessages) {
+    auto messageOf = [this](const char* expression) {
+        try {
+            calc.calculate(expression);
+        } catch (const std::runtime_error& e) {
+            return std::string(e.what());
+        }
+        return std::string();
+    };
+    EXPECT_EQ(messageOf("1/0"), "Division by zero");
+    EXPECT_EQ(messageOf("(1"), "Mismatched parentheses");
+    EXPECT_EQ(messageOf("1$"), "Invalid character in expression: $");
+    EXPECT_EQ(messageOf("1.2.3"), "Invalid number: 1.2.3");
+    EXPECT_EQ(messageOf("2*rate"), "Unbound variable: rate");
+    EXPECT_EQ(messageOf("1+"), "Invalid expression: not enough operands");
+}
+
+TEST_F(CalculatorTest, MemoryRegister) {
+    EXPECT_EQ(calc.recallMemory(), 0.0);
+    calc.storeInMemory(12.5);
+    calc.storeInMemory(calc.recallMemory() + calc.calculate("2*3"));
+    EXPECT_EQ(calc.recallMemory(), 18.5);
+    calc.clearMemory();
+    EXPECT_EQ(calc.recallMemory(), 0.0);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,87 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/calculator_stats.hpp"
+
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+class CalculatorStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!calculator_stats::kEnabled) {
+            GTEST_SKIP() << "Built without CALCULATOR_ENABLE_STATS";
+        }
+        calculator_stats::reset();
+    }
+
+    CalculatorCore calc;
+};
+
+TEST(CalculatorStatsDisabledTest, SnapshotIsEmptyWhenCompiledOut) {
+    if (calculator_stats::kEnabled) {
+        GTEST_SKIP() << "Built with CALCULATOR_ENABLE_STATS";
+    }
+    CalculatorCore calc;
+    calc.calculate("1+2");
+    EXPECT_EQ(calculator_stats::snapshot().calculations, 0u);
+}
+
+TEST_F(CalculatorStatsTest, CountsStagesAndTokens) {
+    calc.calculate("1+2*3");
+    calc.calculate("((4))");
+
+    auto stats = calculator_stats::snapshot();
+    EXPECT_EQ(stats.calculations, 2u);
+    EXPECT_EQ(stats.tokens, 5u + 5u);
+    EXPECT_EQ(stats.stage(calculator_stats::Stage::Tokenize).count, 2u);
+    EXPECT_EQ(stats.stage(calculator_stats::Stage::ShuntingYard).count, 2u);
+    EXPECT_EQ(stats.stage(calculator_stats::Stage::Evaluate).count, 2u);
+    EXPECT_EQ(stats.maxOperatorStackDepth, 2u);
+}
+
+TEST_F(CalculatorStatsTest, PrattFallbackCountsOneCalculation) {
+    calc.setEngine(CalculatorCore::Engine::Pratt);
+    calc.calculate("1+2*3");
+    // Deeper than the Pratt parser recurses, so it falls back to the pipeline
+    std::string deep = std::string(3000, '(') + "1" + std::string(3000, ')');
+    EXPECT_EQ(calc.calculate(deep), 1);
+
+    auto stats = calculator_stats::snapshot();
+    EXPECT_EQ(stats.calculations, 2u);
+    EXPECT_EQ(stats.tokens, 5u + 6001u);
+    EXPECT_EQ(stats.stage(calculator_stats::Stage::Pratt).count, 2u);
+    EXPECT_EQ(stats.stage(calculator_stats::Stage::Tokenize).count, 1u);
+}
+
+TEST_F(CalculatorStatsTest, CountsErrorsByKind) {
+    using calculator_stats::ErrorKind;
+    EXPECT_THROW(calc.calculate("1/0"), std::runtime_error);
+    EXPECT_THROW(calc.calculate("(1"), std::runtime_error);
+    EXPECT_THROW(calc.calculate("1$"), std::runtime_error);
+    EXPECT_THROW(calc.calculate("1+"), std::runtime_error);
+
+    auto stats = calculator_stats::snapshot();
+    EXPECT_EQ(stats.errorCount(ErrorKind::DivisionByZero), 1u);
+    EXPECT_EQ(stats.errorCount(ErrorKind::MismatchedParentheses), 1u);
+    EXPECT_EQ(stats.errorCount(ErrorKind::InvalidCharacter), 1u);
+    EXPECT_EQ(stats.errorCount(ErrorKind::NotEnoughOperands), 1u);
+    EXPECT_EQ(stats.errorCount(ErrorKind::TooManyOperands), 0u);
+}
+
+TEST_F(CalculatorStatsTest, AggregatesExitedThreads) {
+    std::thread worker([] {
+        CalculatorCore local;
+        for (int i = 0; i < 10; i++) {
+            local.calculate("2^10");
+        }
+    });
+    worker.join();
+    calc.calculate("1");
+
+    auto stats = calculator_stats::snapshot();
+    EXPECT_EQ(stats.calculations, 11u);
+    const auto& evaluate = stats.stage(calculator_stats::Stage::Evaluate);
+    EXPECT_EQ(evaluate.count, 11u);
+    EXPECT_GE(evaluate.percentileNanoseconds(99), evaluate.percentileNanoseconds(50));
+}
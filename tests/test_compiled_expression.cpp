@@ -0,0 +1,162 @@
+#include "calculator/calculator_core.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+class CompiledExpressionTest : public ::testing::Test {
+protected:
+    CalculatorCore calc;
+};
+
+TEST_F(CompiledExpressionTest, MatchesCalculate) {
+    for (const char* expression : {"1+2*3", "(1+2)*3", "-2^2", "2^-1", "-(1+2)*-3", "1.5/-0.5"}) {
+        EXPECT_EQ(calc.compile(expression).evaluate(), calc.calculate(expression)) << expression;
+    }
+}
+
+TEST_F(CompiledExpressionTest, PositionalVariables) {
+    auto expr = calc.compile("x*x + y - x");
+    ASSERT_EQ(expr.variables(), (std::vector<std::string>{"x", "y"}));
+    EXPECT_EQ(expr.variableIndex("y"), 1u);
+    EXPECT_FALSE(expr.variableIndex("z").has_value());
+    EXPECT_EQ(expr.evaluate({3, 1}), 7);
+    EXPECT_EQ(expr.evaluate({-2, 0.5}), 6.5);
+}
+
+TEST_F(CompiledExpressionTest, NamedVariables) {
+    auto expr = calc.compile("-rate_1 * (t + 1)");
+    EXPECT_EQ(expr.evaluate({{"rate_1", 2.0}, {"t", 4.0}, {"unused", 9.0}}), -10);
+    EXPECT_THROW(expr.evaluate({{"t", 4.0}}), std::runtime_error);
+    EXPECT_THROW(expr.evaluate({2.0}), std::runtime_error);
+}
+
+TEST_F(CompiledExpressionTest, Errors) {
+    EXPECT_THROW(calc.compile("1+"), std::runtime_error);
+    EXPECT_THROW(calc.compile("(1+2"), std::runtime_error);
+    EXPECT_THROW(calc.compile("1 2"), std::runtime_error);
+    EXPECT_THROW(calc.compile("1$2"), std::runtime_error);
+    EXPECT_THROW(calc.calculate("x+1"), std::runtime_error);
+
+    auto expr = calc.compile("1/x");
+    EXPECT_EQ(expr.evaluate({4}), 0.25);
+    EXPECT_THROW(expr.evaluate({0}), std::runtime_error);
+}
+
+TEST_F(CompiledExpressionTest, ErrorPositions) {
+    auto expr = calc.compile("1 + 2/(x-1)");
+    CalcResult result = expr.tryEvaluate({1});
+    EXPECT_EQ(result.error, CalcError::DivisionByZero);
+    EXPECT_EQ(result.position, 5u);
+    EXPECT_EQ(expr.tryEvaluate({}).error, CalcError::UnboundVariable);
+    EXPECT_EQ(CompiledExpression().tryEvaluate({}).error, CalcError::EmptyExpression);
+}
+
+TEST_F(CompiledExpressionTest, DeepStackSpillsToHeap) {
+    // Right-nested operands keep every intermediate value on the stack
+    std::string expression;
+    for (int i = 0; i < 200; i++) {
+        expression += "x+(";
+    }
+    expression += "1";
+    expression.append(200, ')');
+
+    auto expr = calc.compile(expression);
+    EXPECT_EQ(expr.evaluate({3}), 601);
+    EXPECT_EQ(expr.evaluate({0}), 1);
+}
+
+TEST_F(CompiledExpressionTest, LongChainMatchesCalculate) {
+    std::string expression = "1";
+    static constexpr const char* kSteps[] = {"+2.5", "*3", "-0.75", "/1.5", "^1.01", "+-4"};
+    for (int i = 0; i < 3000; i++) {
+        expression += kSteps[i % std::size(kSteps)];
+    }
+    EXPECT_EQ(calc.compile(expression).evaluate(), calc.calculate(expression));
+}
+
+TEST_F(CompiledExpressionTest, FoldsConstantSubexpressions) {
+    auto expr = calc.compile("(2^10)*x/4");
+    EXPECT_EQ(expr.opsSaved(), 2u);
+    EXPECT_EQ(expr.evaluate({2}), 512);
+    EXPECT_EQ(calc.compile("(2^10)*x/4", {false}).opsSaved(), 0u);
+
+    auto constant = calc.compile("-(1+2)*-3 - 2^-1");
+    EXPECT_EQ(constant.opsSaved(), 11u);
+    EXPECT_EQ(constant.evaluate(), 8.5);
+}
+
+TEST_F(CompiledExpressionTest, AppliesIdentities) {
+    auto expr = calc.compile("(x*1 + 0 - 0) / 1 + 1*y^1 + 0*1");
+    EXPECT_EQ(expr.opsSaved(), 16u);
+    EXPECT_EQ(expr.evaluate({3, 4}), 7);
+
+    EXPECT_EQ(calc.compile("--x").opsSaved(), 2u);
+    EXPECT_EQ(calc.compile("--x").evaluate({5}), 5);
+
+    auto square = calc.compile("(x+1)^2");
+    for (double x : {-3.5, 0.1, 7.0, 1e200}) {
+        EXPECT_EQ(square.evaluate({x}), calc.compile("(x+1)^2", {false}).evaluate({x})) << x;
+    }
+}
+
+TEST_F(CompiledExpressionTest, PreservesDivisionByZero) {
+    for (const char* expression : {"x/(1-1)", "1/0*x", "(1/0)*0 + x", "x*1/(2-2)"}) {
+        CalcResult optimized = calc.compile(expression).tryEvaluate({1});
+        CalcResult reference = calc.compile(expression, {false}).tryEvaluate({1});
+        EXPECT_EQ(optimized.error, CalcError::DivisionByZero) << expression;
+        EXPECT_EQ(optimized.position, reference.position) << expression;
+    }
+    EXPECT_EQ(calc.compile("x/(1-1)", {true, true}).tryEvaluate({1}).error, CalcError::DivisionByZero);
+}
+
+TEST_F(CompiledExpressionTest, FastMathUsesReciprocal) {
+    EXPECT_EQ(calc.compile("x/4", {true, true}).evaluate({3}), 0.75);
+    EXPECT_NEAR(calc.compile("x/3", {true, true}).evaluate({1}), 1.0 / 3.0, 1e-16);
+    EXPECT_EQ(calc.compile("x/3", {true, true}).opsSaved(), 0u);
+}
+
+TEST_F(CompiledExpressionTest, OptimizedMatchesUnoptimized) {
+    static constexpr const char* kOperands[] = {"x", "y", "0", "1", "2", "0.5", "3"};
+    static constexpr char kOperators[] = {'+', '-', '*', '/', '^'};
+    std::mt19937 rng(42);
+
+    for (int i = 0; i < 2000; i++) {
+        std::string expression;
+        int open = 0;
+        for (int term = 0; term < 8; term++) {
+            if (term > 0) {
+                expression += kOperators[rng() % std::size(kOperators)];
+            }
+            if (rng() % 4 == 0) {
+                expression += '-';
+            }
+            if (rng() % 3 == 0) {
+                expression += '(';
+                open++;
+            }
+            expression += kOperands[rng() % std::size(kOperands)];
+            if (open > 0 && rng() % 3 == 0) {
+                expression += ')';
+                open--;
+            }
+        }
+        expression.append(open, ')');
+
+        auto optimized = calc.compile(expression);
+        auto reference = calc.compile(expression, {false});
+        for (double x : {-2.0, 0.0, 1.5}) {
+            for (double y : {-0.5, 1.0, 3.0}) {
+                CalcResult expected = reference.tryEvaluate({x, y});
+                CalcResult actual = optimized.tryEvaluate({x, y});
+                ASSERT_EQ(actual.error, expected.error) << expression;
+                ASSERT_EQ(actual.position, expected.position) << expression;
+                if (expected.ok() && !std::isnan(expected.value)) {
+                    ASSERT_EQ(actual.value, expected.value) << expression << " x=" << x << " y=" << y;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "calculator/constexpr_expression.hpp"
+#include "calculator/calculator_core.hpp"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+// Evaluated by the compiler: any of these failing to parse would break the build
+static_assert(CALCULATOR_CONSTANT("1 + 2 * 3") == 7);
+static_assert(CALCULATOR_CONSTANT("2^3^2") == 512);
+static_assert(CALCULATOR_CONSTANT("-2^2") == -4);
+static_assert(CALCULATOR_CONSTANT("(1 + 2) * -(3 - 5) / 4") == 1.5);
+static_assert(CALCULATOR_CONSTANT("2^-3 + +1") == 1.125);
+static_assert(calculator_constexpr::parse("x * (2^10 / 4)").size == 3);
+static_assert(calculator_constexpr::parse("y + x*y").variableCount == 2);
+static_assert(!calculator_constexpr::parse("2^0.5").isConstant());
+// Results that would overflow are left to runtime rather than failing to compile
+static_assert(!calculator_constexpr::parse("0^-1").isConstant());
+static_assert(!calculator_constexpr::parse("2^1023*2^1023").isConstant());
+static_assert(CALCULATOR_CONSTANT("2^1022 + 2^1022") == 0x1p1023);
+
+class ConstexprExpressionTest : public ::testing::Test {
+protected:
+    CalculatorCore calc;
+};
+
+#define EXPECT_MATCHES_RUNTIME(text) EXPECT_EQ(CALCULATOR_CONSTANT(text), calc.calculate(text)) << text
+
+TEST_F(ConstexprExpressionTest, ConstantsMatchRuntime) {
+    EXPECT_MATCHES_RUNTIME("0.1 + 0.2");
+    EXPECT_MATCHES_RUNTIME("3.14159 * 2.5^2");
+    EXPECT_MATCHES_RUNTIME("1 / 3 - .25");
+    EXPECT_MATCHES_RUNTIME("123456.789 / 1000 * 7");
+    EXPECT_MATCHES_RUNTIME("-(4 - 6)^3 * 2^-10");
+    EXPECT_MATCHES_RUNTIME("1. + .5 - 0.000001");
+}
+
+TEST_F(ConstexprExpressionTest, FormulaMatchesCompiledExpression) {
+    static const auto kinetic = CALCULATOR_FORMULA("0.5 * m * v^2");
+    static_assert(decltype(kinetic)::kVariables == 2);
+    EXPECT_EQ(decltype(kinetic)::variable(0), "m");
+    EXPECT_EQ(decltype(kinetic)::variable(1), "v");
+
+    auto runtime = calc.compile("0.5 * m * v^2");
+    for (double m : {1.0, 2.5, -3.0}) {
+        for (double v : {0.0, 3.0, 1e10}) {
+            EXPECT_EQ(kinetic.evaluate(m, v), runtime.evaluate({m, v}));
+        }
+    }
+
+    static const auto mixed = CALCULATOR_FORMULA("-(x - 1.5)^2 / (2 * 0.25^2) + x^0.5 - -y");
+    auto mixedRuntime = calc.compile("-(x - 1.5)^2 / (2 * 0.25^2) + x^0.5 - -y");
+    for (double x : {0.0, 1.5, 7.25}) {
+        EXPECT_EQ(mixed.evaluate(x, 2.0), mixedRuntime.evaluate({x, 2.0}));
+    }
+}
+
+TEST_F(ConstexprExpressionTest, FormulaReportsDivisionByZero) {
+    static const auto ratio = CALCULATOR_FORMULA("1 + x / (y - 1)");
+    EXPECT_EQ(ratio.evaluate(4, 3), 3);
+    CalcResult result = ratio.tryEvaluate(4, 1);
+    EXPECT_EQ(result.error, CalcError::DivisionByZero);
+    EXPECT_EQ(result.position, 6u);
+    EXPECT_THROW(ratio.evaluate(4, 1), std::runtime_error);
+}
+
+TEST_F(ConstexprExpressionTest, OverflowingConstantsMatchRuntime) {
+    static const auto reciprocal = CALCULATOR_FORMULA("0^-1");
+    static const auto product = CALCULATOR_FORMULA("2^1023*2^1023");
+    static const auto cube = CALCULATOR_FORMULA("-(2^1000)^3 / 0.5");
+    EXPECT_EQ(reciprocal.evaluate(), calc.calculate("0^-1"));
+    EXPECT_EQ(product.evaluate(), calc.calculate("2^1023*2^1023"));
+    EXPECT_EQ(cube.evaluate(), calc.calculate("-(2^1000)^3 / 0.5"));
+    EXPECT_EQ(product.evaluate(), std::numeric_limits<double>::infinity());
+}
+
+TEST_F(ConstexprExpressionTest, ConstantFormula) {
+    static const auto constant = CALCULATOR_FORMULA("(2^10) * 3");
+    static_assert(decltype(constant)::kProgram.isConstant());
+    EXPECT_EQ(constant.evaluate(), 3072);
+}
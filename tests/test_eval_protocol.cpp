@@ -0,0 +1,90 @@
+#include "calculator/eval_protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+
+using eval_protocol::ParseStatus;
+
+TEST(EvalProtocolTest, RequestRoundTrip) {
+    std::string stream;
+    eval_protocol::appendRequest(stream, 7, "1 + 2");
+    eval_protocol::appendRequest(stream, 0xFFFFFFFF, "");
+    ASSERT_EQ(stream.size(), 2 * (eval_protocol::kLengthBytes + 4) + 5);
+
+    eval_protocol::Request request;
+    size_t consumed = 0;
+    ASSERT_EQ(eval_protocol::parseRequest(stream.data(), stream.size(), request, consumed), ParseStatus::Complete);
+    EXPECT_EQ(request.id, 7u);
+    EXPECT_EQ(request.expression, "1 + 2");
+
+    size_t offset = consumed;
+    ASSERT_EQ(eval_protocol::parseRequest(stream.data() + offset, stream.size() - offset, request, consumed),
+              ParseStatus::Complete);
+    EXPECT_EQ(request.id, 0xFFFFFFFFu);
+    EXPECT_EQ(request.expression, "");
+    EXPECT_EQ(offset + consumed, stream.size());
+}
+
+TEST(EvalProtocolTest, ResponseRoundTrip) {
+    std::string stream;
+    eval_protocol::appendResponse(stream, 1, CalcResult::success(-0.1));
+    eval_protocol::appendResponse(stream, 2, CalcResult::failure(CalcError::DivisionByZero, 3));
+    eval_protocol::appendResponse(stream, 3, CalcResult::success(INFINITY));
+    // Fixed-size and little-endian, so the layout is stable across hosts
+    EXPECT_EQ(stream.substr(0, 8), std::string("\x11\0\0\0\x01\0\0\0", 8));
+
+    eval_protocol::Response response;
+    size_t consumed = 0;
+    size_t offset = 0;
+    ASSERT_EQ(eval_protocol::parseResponse(stream.data(), stream.size(), response, consumed), ParseStatus::Complete);
+    EXPECT_EQ(response.id, 1u);
+    EXPECT_EQ(response.result.value, -0.1);
+    EXPECT_TRUE(response.result.ok());
+
+    offset += consumed;
+    ASSERT_EQ(eval_protocol::parseResponse(stream.data() + offset, stream.size() - offset, response, consumed),
+              ParseStatus::Complete);
+    EXPECT_EQ(response.id, 2u);
+    EXPECT_EQ(response.result.error, CalcError::DivisionByZero);
+    EXPECT_EQ(response.result.position, 3u);
+
+    offset += consumed;
+    ASSERT_EQ(eval_protocol::parseResponse(stream.data() + offset, stream.size() - offset, response, consumed),
+              ParseStatus::Complete);
+    EXPECT_TRUE(std::isinf(response.result.value));
+}
+
+TEST(EvalProtocolTest, PartialFramesAreIncomplete) {
+    std::string stream;
+    eval_protocol::appendRequest(stream, 1, "2 * 3");
+    eval_protocol::Request request;
+    size_t consumed = 0;
+    for (size_t size = 0; size < stream.size(); size++) {
+        EXPECT_EQ(eval_protocol::parseRequest(stream.data(), size, request, consumed), ParseStatus::Incomplete)
+            << size;
+    }
+
+    std::string responses;
+    eval_protocol::appendResponse(responses, 1, CalcResult::success(6));
+    eval_protocol::Response response;
+    EXPECT_EQ(eval_protocol::parseResponse(responses.data(), responses.size() - 1, response, consumed),
+              ParseStatus::Incomplete);
+}
+
+TEST(EvalProtocolTest, RejectsBadLengths) {
+    eval_protocol::Request request;
+    size_t consumed = 0;
+    // Too short to hold an id
+    std::string tooShort("\x03\0\0\0abc", 7);
+    EXPECT_EQ(eval_protocol::parseRequest(tooShort.data(), tooShort.size(), request, consumed), ParseStatus::Invalid);
+    // Over the limit: rejected from the prefix alone, before the payload arrives
+    std::string tooLong("\0\0\0\x7F", 4);
+    EXPECT_EQ(eval_protocol::parseRequest(tooLong.data(), tooLong.size(), request, consumed), ParseStatus::Invalid);
+
+    eval_protocol::Response response;
+    std::string wrongSize("\x05\0\0\0\0\0\0\0\0", 9);
+    EXPECT_EQ(eval_protocol::parseResponse(wrongSize.data(), wrongSize.size(), response, consumed),
+              ParseStatus::Invalid);
+}
@@ -0,0 +1,241 @@
+#include "calculator/eval_client.hpp"
+#include "calculator/eval_server.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+/**
+ * @brief Raw connection, for socket-level behavior the client does not expose
+ */
+int connectRaw(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+class EvalServerTest : public ::testing::Test {
+protected:
+    std::string m_path;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        m_path = (std::filesystem::temp_directory_path() / (std::string("calc_") + info->name() + ".sock")).string();
+        std::remove(m_path.c_str());
+    }
+
+    void TearDown() override { std::remove(m_path.c_str()); }
+
+    EvalServer::Options options(size_t ioThreads = 2, size_t workers = 2) const {
+        EvalServer::Options result;
+        result.socketPath = m_path;
+        result.ioThreads = ioThreads;
+        result.workerThreads = workers;
+        result.maxBatch = 16;
+        return result;
+    }
+};
+} // namespace
+
+TEST_F(EvalServerTest, AnswersPipelinedRequests) {
+    EvalServer server(options());
+    EvalClient client(m_path);
+
+    constexpr uint32_t kRequests = 5000;
+    for (uint32_t id = 0; id < kRequests; id++) {
+        client.send(id, std::to_string(id) + " * 2 + 1");
+    }
+    client.send(kRequests, "1 / 0");
+
+    std::vector<bool> seen(kRequests + 1, false);
+    eval_protocol::Response response;
+    for (uint32_t i = 0; i <= kRequests; i++) {
+        ASSERT_TRUE(client.receive(response));
+        ASSERT_LE(response.id, kRequests);
+        EXPECT_FALSE(seen[response.id]);
+        seen[response.id] = true;
+        if (response.id == kRequests) {
+            EXPECT_EQ(response.result.error, CalcError::DivisionByZero);
+        } else {
+            EXPECT_TRUE(response.result.ok());
+            EXPECT_EQ(response.result.value, response.id * 2.0 + 1);
+        }
+    }
+    EXPECT_EQ(server.requestsServed(), kRequests + 1);
+}
+
+TEST_F(EvalServerTest, ServesConcurrentConnections) {
+    EvalServer server(options(3, 4));
+    constexpr int kClients = 8;
+    constexpr uint32_t kRequests = 2000;
+    std::vector<int> correct(kClients, 0);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kClients; c++) {
+        threads.emplace_back([&, c] {
+            EvalClient client(m_path);
+            eval_protocol::Response response;
+            // Keep a window in flight rather than sending everything up front
+            uint32_t sent = 0;
+            for (uint32_t received = 0; received < kRequests; received++) {
+                while (sent < kRequests && sent - received < 32) {
+                    client.send(sent, std::to_string(c) + " + " + std::to_string(sent));
+                    sent++;
+                }
+                if (client.receive(response) && response.result.value == c + static_cast<double>(response.id)) {
+                    correct[c]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int c = 0; c < kClients; c++) {
+        EXPECT_EQ(correct[c], static_cast<int>(kRequests)) << c;
+    }
+}
+
+TEST_F(EvalServerTest, HalfClosedClientStillGetsResponses) {
+    EvalServer server(options());
+    int fd = connectRaw(m_path);
+    ASSERT_GE(fd, 0);
+    std::string requests;
+    for (uint32_t id = 0; id < 100; id++) {
+        eval_protocol::appendRequest(requests, id, "6 * 7");
+    }
+    ASSERT_EQ(::write(fd, requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+    ::shutdown(fd, SHUT_WR);
+
+    // The server answers everything it read, then closes its end
+    std::string received;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, count);
+    }
+    ::close(fd);
+    EXPECT_EQ(received.size(), 100 * (eval_protocol::kLengthBytes + eval_protocol::kResponsePayload));
+}
+
+TEST_F(EvalServerTest, LargeRequestsAreServedWithinByteLimits) {
+    EvalServer::Options large = options();
+    large.maxBatch = 4096;
+    EvalServer server(large);
+    EvalClient client(m_path);
+
+    // Together well over kMaxPendingRequestBytes, so reading can pause and resume on frames already buffered
+    constexpr uint32_t kRequests = 64;
+    const std::string padding(eval_protocol::kMaxRequestPayload / 2, ' ');
+    static_assert(kRequests * eval_protocol::kMaxRequestPayload / 2 > EvalServer::kMaxPendingRequestBytes);
+    for (uint32_t id = 0; id < kRequests; id++) {
+        client.send(id, std::to_string(id) + padding + "+ 1");
+    }
+
+    std::vector<bool> seen(kRequests, false);
+    eval_protocol::Response response;
+    for (uint32_t i = 0; i < kRequests; i++) {
+        ASSERT_TRUE(client.receive(response));
+        ASSERT_LT(response.id, kRequests);
+        EXPECT_FALSE(seen[response.id]);
+        seen[response.id] = true;
+        EXPECT_EQ(response.result.value, response.id + 1.0);
+    }
+}
+
+TEST_F(EvalServerTest, ClientThatNeverReadsIsThrottled) {
+    EvalServer server(options());
+    int fd = connectRaw(m_path);
+    ASSERT_GE(fd, 0);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    std::string requests;
+    for (uint32_t id = 0; id < 4096; id++) {
+        eval_protocol::appendRequest(requests, id, "1");
+    }
+    // Pipeline without reading until the server has stopped taking input for a while
+    size_t offset = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline) {
+        ssize_t count = ::write(fd, requests.data() + offset, requests.size() - offset);
+        if (count > 0) {
+            offset = (offset + count) % requests.size();
+            continue;
+        }
+        pollfd writable{fd, POLLOUT, 0};
+        if (::poll(&writable, 1, 300) == 0) {
+            break;
+        }
+    }
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "the server never stopped reading";
+
+    uint64_t served = server.requestsServed();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(server.requestsServed(), served);
+    // Bounded by the pending and unsent caps plus what the socket buffers hold
+    EXPECT_LT(served, 8 * EvalServer::kMaxPendingRequests);
+    ::close(fd);
+}
+
+TEST_F(EvalServerTest, MalformedFrameClosesConnection) {
+    EvalServer server(options());
+    EvalClient bad(m_path);
+    bad.sendRaw(std::string("\x02\0\0\0xx", 6));
+    eval_protocol::Response response;
+    EXPECT_FALSE(bad.receive(response));
+
+    // Other clients are unaffected
+    EvalClient good(m_path);
+    good.send(9, "2^3");
+    ASSERT_TRUE(good.receive(response));
+    EXPECT_EQ(response.id, 9u);
+    EXPECT_EQ(response.result.value, 8);
+}
+
+TEST_F(EvalServerTest, SocketPathOwnership) {
+    {
+        EvalServer server(options());
+        // A live server keeps its socket
+        EXPECT_THROW(EvalServer second(options()), std::runtime_error);
+        EvalClient client(m_path);
+        client.send(1, "1");
+        eval_protocol::Response response;
+        EXPECT_TRUE(client.receive(response));
+    }
+    EXPECT_FALSE(std::filesystem::exists(m_path));
+    EXPECT_THROW(EvalClient client(m_path), std::runtime_error);
+
+    // A socket file nobody listens on, as a crashed server leaves behind, is replaced
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, m_path.c_str(), m_path.size() + 1);
+    int stale = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(::bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ::close(stale);
+    ASSERT_TRUE(std::filesystem::exists(m_path));
+
+    EvalServer server(options(1, 1));
+    EvalClient client(m_path);
+    client.send(1, "3 - 1");
+    eval_protocol::Response response;
+    ASSERT_TRUE(client.receive(response));
+    EXPECT_EQ(response.result.value, 2);
+}
@@ -0,0 +1,115 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/function_sampler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+using Point = FunctionSampler::Point;
+
+FunctionSampler samplerFor(const char* expression, size_t cacheTiles = 512) {
+    CalculatorCore calc;
+    return FunctionSampler(calc.compile(expression), cacheTiles);
+}
+
+bool sortedByX(const std::vector<Point>& points) {
+    return std::is_sorted(points.begin(), points.end(), [](const Point& a, const Point& b) { return a.x < b.x; });
+}
+} // namespace
+
+TEST(FunctionSamplerTest, SamplesCoverRange) {
+    FunctionSampler sampler = samplerFor("x^2 - 3");
+    std::vector<Point> points;
+    sampler.sample(-2.0, 3.0, 500, points);
+
+    ASSERT_FALSE(points.empty());
+    EXPECT_TRUE(sortedByX(points));
+    EXPECT_LE(points.front().x, -2.0);
+    EXPECT_GE(points.back().x, 3.0);
+    EXPECT_GE(std::count_if(points.begin(), points.end(), [](const Point& p) { return p.x >= -2.0 && p.x <= 3.0; }),
+              500);
+    for (const Point& p : points) {
+        EXPECT_DOUBLE_EQ(p.y, p.x * p.x - 3) << p.x;
+    }
+}
+
+TEST(FunctionSamplerTest, StraightLinesAreNotRefined) {
+    FunctionSampler sampler = samplerFor("2 * x + 1");
+    std::vector<Point> points;
+    sampler.sample(0.0, 1.0, 1000, points);
+    // One tile's worth of base samples per tile, nothing more
+    EXPECT_EQ(sampler.samplesEvaluated(), sampler.stats().misses * (FunctionSampler::kTileSamples + 1));
+}
+
+TEST(FunctionSamplerTest, ErrorsBecomeGapsAndEdgesAreRefined) {
+    FunctionSampler sampler = samplerFor("1 / x");
+    std::vector<Point> points;
+    ASSERT_NO_THROW(sampler.sample(-1.0, 1.0, 256, points));
+    EXPECT_TRUE(sortedByX(points));
+
+    auto zero = std::find_if(points.begin(), points.end(), [](const Point& p) { return p.x == 0.0; });
+    ASSERT_NE(zero, points.end());
+    EXPECT_TRUE(std::isnan(zero->y));
+    EXPECT_EQ(std::count_if(points.begin(), points.end(), [](const Point& p) { return std::isnan(p.y); }), 1);
+
+    // Bisection narrows in on the pole well below the base spacing
+    double baseSpacing = std::ldexp(1.0, std::ilogb(2.0 / 256));
+    auto next = zero + 1;
+    ASSERT_NE(next, points.end());
+    EXPECT_LE(next->x - zero->x, baseSpacing / (1 << FunctionSampler::kMaxRefineDepth));
+    EXPECT_GT(points.size(), 2 * 256u);
+}
+
+TEST(FunctionSamplerTest, PanningReusesCachedTiles) {
+    FunctionSampler sampler = samplerFor("x * x * x - x");
+    std::vector<Point> points;
+    sampler.sample(-1.0, 1.0, 1024, points);
+    uint64_t misses = sampler.stats().misses;
+    uint64_t evaluated = sampler.samplesEvaluated();
+    EXPECT_GT(misses, 0u);
+
+    // Redrawing the same view evaluates nothing
+    sampler.sample(-1.0, 1.0, 1024, points);
+    EXPECT_EQ(sampler.stats().misses, misses);
+    EXPECT_EQ(sampler.samplesEvaluated(), evaluated);
+
+    // Spacing is 2^-9, so tiles are half a unit wide; panning by 0.6 exposes one new tile
+    sampler.sample(-0.4, 1.6, 1024, points);
+    EXPECT_EQ(sampler.stats().misses, misses + 1);
+
+    // Zooming out within the same power-of-two spacing only evaluates the tiles at the new edges
+    misses = sampler.stats().misses;
+    sampler.sample(-1.5, 1.5, 1024, points);
+    EXPECT_EQ(sampler.stats().misses, misses + 1);
+}
+
+TEST(FunctionSamplerTest, CacheIsBounded) {
+    FunctionSampler sampler = samplerFor("x", 4);
+    std::vector<Point> points;
+    for (int i = 0; i < 100; i++) {
+        sampler.sample(i, i + 1.0, 256, points);
+    }
+    EXPECT_LE(sampler.cachedTiles(), 4u);
+    EXPECT_GT(sampler.stats().evictions, 0u);
+}
+
+TEST(FunctionSamplerTest, EdgeCases) {
+    std::vector<Point> points;
+    FunctionSampler constant = samplerFor("4 / 2");
+    constant.sample(0.0, 10.0, 100, points);
+    ASSERT_FALSE(points.empty());
+    EXPECT_TRUE(std::all_of(points.begin(), points.end(), [](const Point& p) { return p.y == 2.0; }));
+
+    constant.sample(1.0, 1.0, 100, points);
+    EXPECT_TRUE(points.empty());
+    constant.sample(0.0, 1.0, 0, points);
+    EXPECT_TRUE(points.empty());
+    constant.sample(0.0, INFINITY, 100, points);
+    EXPECT_TRUE(points.empty());
+
+    CalculatorCore calc;
+    EXPECT_THROW(FunctionSampler(calc.compile("x + y")), std::runtime_error);
+}
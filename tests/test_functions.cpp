@@ -0,0 +1,220 @@
+#include "calculator/batch_evaluator.hpp"
+#include "calculator/calculator_core.hpp"
+#include "calculator/function_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+double clamp(const double* a) { return std::fmin(std::fmax(a[0], a[1]), a[2]); }
+
+double sum8(const double* a) {
+    double total = 0.0;
+    for (int i = 0; i < 8; i++) {
+        total += a[i];
+    }
+    return total;
+}
+} // namespace
+
+class FunctionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        pratt.setEngine(CalculatorCore::Engine::Pratt);
+        for (CalculatorCore* c : {&calc, &pratt}) {
+            c->registerFunction("clamp", 3, clamp);
+        }
+    }
+
+    CalculatorCore calc;
+    CalculatorCore pratt;
+};
+
+TEST_F(FunctionTest, BuiltinsEvaluate) {
+    for (CalculatorCore* c : {&calc, &pratt}) {
+        EXPECT_EQ(c->calculate("sqrt(16)"), 4);
+        EXPECT_EQ(c->calculate("max(2, 3) - min(2, 3)"), 1);
+        EXPECT_EQ(c->calculate("hypot(3, 4)"), 5);
+        EXPECT_EQ(c->calculate("abs(-2.5)"), 2.5);
+        EXPECT_DOUBLE_EQ(c->calculate("atan2(1, 1) * 4"), std::acos(-1.0));
+        EXPECT_EQ(c->calculate("max(1, min(5, 3)) + sqrt(4) * 2"), 7);
+        // A call is an operand, so the usual precedence applies around it
+        EXPECT_EQ(c->calculate("-sqrt(4)^2"), -4);
+        EXPECT_EQ(c->calculate("2^floor(2.7)"), 4);
+        EXPECT_EQ(c->calculate("clamp(5, 0, 1) + clamp(-5, 0, 1)"), 1);
+    }
+}
+
+TEST_F(FunctionTest, NamesResolveToStableIds) {
+    const FunctionTable& builtins = FunctionTable::builtins();
+    auto sqrt = builtins.find("sqrt");
+    ASSERT_TRUE(sqrt);
+    EXPECT_EQ(builtins[*sqrt].name, "sqrt");
+    EXPECT_EQ(builtins[*sqrt].arity, 1);
+    EXPECT_EQ(calc.functions().find("sqrt"), sqrt);
+    EXPECT_FALSE(builtins.find("clamp"));
+    EXPECT_FALSE(builtins.find("sqr"));
+
+    // Registered functions follow the built-ins
+    auto id = calc.functions().find("clamp");
+    ASSERT_TRUE(id);
+    EXPECT_EQ(*id, builtins.size());
+    EXPECT_EQ(calc.functions().size(), builtins.size() + 1);
+}
+
+TEST_F(FunctionTest, RegistrationIsValidated) {
+    EXPECT_THROW(calc.registerFunction("clamp", 3, clamp), std::runtime_error);
+    EXPECT_THROW(calc.registerFunction("sqrt", 1, clamp), std::runtime_error);
+    EXPECT_THROW(calc.registerFunction("f", 0, clamp), std::runtime_error);
+    EXPECT_THROW(calc.registerFunction("f", FunctionTable::kMaxArity + 1, clamp), std::runtime_error);
+    EXPECT_THROW(calc.registerFunction("2f", 1, clamp), std::runtime_error);
+    EXPECT_THROW(calc.registerFunction("", 1, clamp), std::runtime_error);
+
+    calc.registerFunction("sum8", 8, sum8);
+    EXPECT_EQ(calc.calculate("sum8(1, 2, 3, 4, 5, 6, 7, 8)"), 36);
+
+    // Functions belong to the calculator they were registered with
+    CalculatorCore other;
+    EXPECT_EQ(other.tryCalculate("clamp(1, 2, 3)").error, CalcError::UnknownFunction);
+}
+
+TEST_F(FunctionTest, ErrorPositions) {
+    struct Case {
+        const char* expression;
+        CalcError error;
+        uint32_t position;
+    };
+    for (const Case& c : {
+             Case{"foo(1)", CalcError::UnknownFunction, 0},
+             Case{"1 + foo(1)", CalcError::UnknownFunction, 4},
+             Case{"max(1)", CalcError::WrongArgumentCount, 5},
+             Case{"sqrt(1, 2)", CalcError::WrongArgumentCount, 6},
+             Case{"max(1, 2, 3)", CalcError::WrongArgumentCount, 8},
+             Case{"(1, 2)", CalcError::WrongArgumentCount, 2},
+             Case{"max((1, 2), 3)", CalcError::WrongArgumentCount, 6},
+             Case{"1, 2", CalcError::WrongArgumentCount, 1},
+             Case{"max(1, 2", CalcError::MismatchedParentheses, 3},
+             Case{"max(, 1)", CalcError::NotEnoughOperands, 4},
+             Case{"max()", CalcError::NotEnoughOperands, 4},
+             Case{"max(1,)", CalcError::NotEnoughOperands, 6},
+             // A name followed by whitespace is a variable, not a call
+             Case{"sqrt (4)", CalcError::TooManyOperands, 5},
+             Case{"sqrt", CalcError::UnboundVariable, 0},
+             // Lexical errors still take priority
+             Case{"max(1) + $", CalcError::InvalidCharacter, 9},
+         }) {
+        for (CalculatorCore* calculator : {&calc, &pratt}) {
+            CalcResult result = calculator->tryCalculate(c.expression);
+            EXPECT_EQ(result.error, c.error) << c.expression;
+            EXPECT_EQ(result.position, c.position) << c.expression;
+        }
+    }
+    EXPECT_EQ(formatError(calc.tryCalculate("2 * foo_1(3)"), "2 * foo_1(3)"), "Unknown function: foo_1");
+    EXPECT_THROW(calc.compile("max(x)"), std::runtime_error);
+}
+
+TEST_F(FunctionTest, CompiledCalls) {
+    auto expression = calc.compile("hypot(x, y) + max(x, 0) * clamp(y, -1, 1)");
+    EXPECT_EQ(expression.variables(), (std::vector<std::string>{"x", "y"}));
+    EXPECT_EQ(expression.evaluate({3, 4}), 8);
+    EXPECT_EQ(expression.evaluate({-3, -4}), 5);
+
+    // Calls with constant arguments fold like any other constant subexpression
+    auto folded = calc.compile("x * sqrt(16) + max(1, 2)");
+    EXPECT_EQ(folded.opsSaved(), 3u);
+    EXPECT_EQ(folded.evaluate({2}), 10);
+
+    // Arguments deeper than the interpreter's local stack
+    std::string deep = "x";
+    for (int i = 0; i < 100; i++) {
+        deep = "max(" + std::to_string(i) + ", 1 + " + deep + ")";
+    }
+    EXPECT_EQ(calc.compile(deep, {false}).evaluate({0}), 100);
+}
+
+TEST_F(FunctionTest, DedicatedOpcodesMatchCallbacks) {
+    // min, max, abs and sqrt compile to opcodes of their own; the same callbacks registered under other
+    // names go through Call, and every path must agree bit for bit, NaN and signed zeros included
+    const FunctionTable& builtins = FunctionTable::builtins();
+    for (const char* name : {"min", "max", "abs", "sqrt"}) {
+        const FunctionTable::Function& function = builtins[*builtins.find(name)];
+        calc.registerFunction(std::string(name) + "_call", function.arity, function.call);
+    }
+    const double nan = std::nan("");
+    std::vector<double> xs = {0.0, -0.0, 0.0, -0.0, nan, 1.0, nan, -4.0, 2.5};
+    std::vector<double> ys = {-0.0, 0.0, 0.0, -0.0, 1.0, nan, nan, 3.0, -7.0};
+    for (const char* expression : {"max(x, y)", "min(x, y)", "abs(x) - abs(y)", "sqrt(x) + sqrt(y)"}) {
+        std::string called = expression;
+        for (size_t at = called.find('('); at != std::string::npos; at = called.find('(', at + 6)) {
+            called.insert(at, "_call");
+        }
+        auto dedicated = calc.compile(expression, {false});
+        auto callback = calc.compile(called, {false});
+        auto batch = BatchEvaluator(calc.compile(expression)).evaluate({xs, ys});
+        for (size_t row = 0; row < xs.size(); row++) {
+            double expected = callback.evaluate({xs[row], ys[row]});
+            double actual = dedicated.evaluate({xs[row], ys[row]});
+            EXPECT_EQ(std::signbit(actual), std::signbit(expected)) << expression << " row " << row;
+            EXPECT_EQ(std::signbit(batch[row]), std::signbit(expected)) << expression << " row " << row;
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(actual)) << expression << " row " << row;
+                EXPECT_TRUE(std::isnan(batch[row])) << expression << " row " << row;
+            } else {
+                EXPECT_EQ(actual, expected) << expression << " row " << row;
+                EXPECT_EQ(batch[row], expected) << expression << " row " << row;
+            }
+        }
+    }
+}
+
+TEST_F(FunctionTest, OptimizedAndBatchMatchUnoptimized) {
+    static constexpr const char* kOperands[] = {"x", "y", "0", "1", "2", "0.5"};
+    struct Call {
+        const char* name;
+        size_t arity;
+    };
+    static constexpr Call kCalls[] = {{"sqrt", 1}, {"max", 2}, {"atan2", 2}, {"clamp", 3}, {"abs", 1}};
+    static constexpr char kOperators[] = {'+', '-', '*', '/', '^'};
+    std::mt19937 rng(7);
+
+    // Builds a random operand, possibly a call whose arguments are themselves random
+    std::function<std::string(int)> operand = [&](int depth) {
+        if (depth > 2 || rng() % 3 != 0) {
+            return std::string(kOperands[rng() % std::size(kOperands)]);
+        }
+        const Call& call = kCalls[rng() % std::size(kCalls)];
+        std::string text = std::string(call.name) + "(";
+        for (size_t i = 0; i < call.arity; i++) {
+            text += (i > 0 ? ", " : "") + operand(depth + 1) + kOperators[rng() % std::size(kOperators)] +
+                    operand(depth + 1);
+        }
+        return text + ")";
+    };
+
+    std::vector<double> xs = {-2.0, 0.0, 1.5, 4.0};
+    std::vector<double> ys = {3.0, -0.5, 1.0, 0.0};
+    for (int i = 0; i < 1000; i++) {
+        std::string expression = operand(0) + kOperators[rng() % std::size(kOperators)] + operand(0) + "+x*y";
+        auto optimized = calc.compile(expression);
+        auto reference = calc.compile(expression, {false});
+        std::vector<unsigned char> errors;
+        auto batch = BatchEvaluator(optimized).evaluate({xs, ys}, &errors);
+        for (size_t row = 0; row < xs.size(); row++) {
+            CalcResult expected = reference.tryEvaluate({xs[row], ys[row]});
+            CalcResult actual = optimized.tryEvaluate({xs[row], ys[row]});
+            ASSERT_EQ(actual.error, expected.error) << expression;
+            ASSERT_EQ(actual.position, expected.position) << expression;
+            ASSERT_EQ(errors[row] != 0, !expected.ok()) << expression;
+            if (expected.ok() && !std::isnan(expected.value)) {
+                ASSERT_EQ(actual.value, expected.value) << expression;
+                ASSERT_EQ(batch[row], expected.value) << expression;
+            }
+        }
+    }
+}
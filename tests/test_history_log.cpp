@@ -0,0 +1,141 @@
+#include "calculator/history_log.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace {
+class HistoryLogTest : public ::testing::Test {
+protected:
+    std::string m_path;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        m_path = (std::filesystem::temp_directory_path() / (std::string("calc_history_") + info->name())).string();
+        removeFiles();
+    }
+
+    void TearDown() override { removeFiles(); }
+
+    void removeFiles() {
+        std::remove(m_path.c_str());
+        std::remove((m_path + ".text").c_str());
+    }
+};
+} // namespace
+
+TEST_F(HistoryLogTest, AppendAndReadBack) {
+    HistoryLog log(m_path);
+    EXPECT_EQ(log.size(), 0u);
+    EXPECT_EQ(log.memory(), 0.0);
+
+    log.append("1 + 2", {3.0, CalcError::None}, 1000);
+    log.append("1 / 0", {0.0, CalcError::DivisionByZero}, 2000);
+    log.append("", {0.0, CalcError::EmptyExpression}, 3000);
+
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[0].expression, "1 + 2");
+    EXPECT_EQ(log[0].value, 3.0);
+    EXPECT_EQ(log[0].error, CalcError::None);
+    EXPECT_EQ(log[0].timestamp, 1000);
+    EXPECT_EQ(log[1].expression, "1 / 0");
+    EXPECT_EQ(log[1].error, CalcError::DivisionByZero);
+    EXPECT_EQ(log[2].expression, "");
+    EXPECT_EQ(log[2].timestamp, 3000);
+}
+
+TEST_F(HistoryLogTest, PersistsAcrossReopen) {
+    {
+        HistoryLog log(m_path);
+        log.append("2 ^ 10", {1024.0, CalcError::None});
+        log.setMemory(42.5);
+    }
+    HistoryLog log(m_path);
+    ASSERT_EQ(log.size(), 1u);
+    EXPECT_EQ(log[0].expression, "2 ^ 10");
+    EXPECT_EQ(log[0].value, 1024.0);
+    EXPECT_GT(log[0].timestamp, 0);
+    EXPECT_EQ(log.memory(), 42.5);
+
+    log.append("3 * 3", {9.0, CalcError::None});
+    EXPECT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[1].expression, "3 * 3");
+}
+
+TEST_F(HistoryLogTest, GrowsPastInitialCapacity) {
+    constexpr size_t kEntries = 100000;
+    {
+        HistoryLog log(m_path);
+        for (size_t i = 0; i < kEntries; i++) {
+            log.append(std::to_string(i) + " * 2", {i * 2.0, CalcError::None}, static_cast<int64_t>(i));
+        }
+        ASSERT_EQ(log.size(), kEntries);
+    }
+    HistoryLog log(m_path);
+    ASSERT_EQ(log.size(), kEntries);
+    for (size_t i : {size_t{0}, size_t{1023}, size_t{1024}, size_t{54321}, kEntries - 1}) {
+        EXPECT_EQ(log[i].expression, std::to_string(i) + " * 2");
+        EXPECT_EQ(log[i].value, i * 2.0);
+        EXPECT_EQ(log[i].timestamp, static_cast<int64_t>(i));
+    }
+}
+
+TEST_F(HistoryLogTest, RejectsInvalidFiles) {
+    {
+        std::ofstream garbage(m_path, std::ios::binary);
+        garbage << "definitely not a history log, but long enough to hold a header........................";
+    }
+    EXPECT_THROW(HistoryLog log(m_path), std::runtime_error);
+
+    // A truncated header is rejected rather than read past the end
+    {
+        std::ofstream truncated(m_path, std::ios::binary | std::ios::trunc);
+        truncated << "CALCHIST";
+    }
+    EXPECT_THROW(HistoryLog log(m_path), std::runtime_error);
+}
+
+TEST_F(HistoryLogTest, SecondWriterIsLockedOut) {
+    HistoryLog log(m_path);
+    log.append("1", {1.0, CalcError::None});
+    EXPECT_THROW(HistoryLog second(m_path), std::runtime_error);
+    EXPECT_EQ(log.size(), 1u);
+}
+
+#if !defined(_WIN32)
+TEST_F(HistoryLogTest, FailedGrowthLeavesLogUsable) {
+    HistoryLog log(m_path);
+    log.append("1 + 1", {2.0, CalcError::None}, 1000);
+    log.setMemory(7.0);
+
+    // Cap file sizes at the initial text capacity, so the next text growth fails with EFBIG
+    rlimit previous{};
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &previous), 0);
+    rlimit capped = previous;
+    capped.rlim_cur = std::filesystem::file_size(m_path + ".text");
+    auto* previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &capped), 0);
+    EXPECT_THROW(log.append(std::string(capped.rlim_cur, '1'), {1.0, CalcError::None}, 2000), std::runtime_error);
+    ::setrlimit(RLIMIT_FSIZE, &previous);
+    std::signal(SIGXFSZ, previousHandler);
+
+    ASSERT_EQ(log.size(), 1u);
+    EXPECT_EQ(log[0].expression, "1 + 1");
+    EXPECT_EQ(log.memory(), 7.0);
+    log.setMemory(8.0);
+    log.append("2 + 2", {4.0, CalcError::None}, 3000);
+    log.append(std::string(100000, '1'), {1.0, CalcError::None}, 4000);
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[1].expression, "2 + 2");
+    EXPECT_EQ(log[2].expression.size(), 100000u);
+    EXPECT_EQ(log.memory(), 8.0);
+}
+#endif
@@ -0,0 +1,224 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/function_table.hpp"
+#include "calculator/incremental_evaluator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace {
+using Preview = IncrementalEvaluator::Preview;
+
+Preview previewOf(const std::string& text) {
+    IncrementalEvaluator evaluator;
+    evaluator.push(text);
+    return evaluator.preview();
+}
+
+// A complete preview must agree with the pipeline; anything else must be an expression the pipeline rejects
+void expectConsistent(CalculatorCore& calc, const IncrementalEvaluator& evaluator) {
+    const std::string& text = evaluator.text();
+    Preview preview = evaluator.preview();
+    CalcResult expected = calc.tryCalculate(text);
+    ASSERT_EQ(preview.status == Preview::Complete, expected.ok()) << '"' << text << '"';
+    if (expected.ok()) {
+        ASSERT_TRUE(preview.hasValue) << '"' << text << '"';
+        if (std::isnan(expected.value)) {
+            ASSERT_TRUE(std::isnan(preview.value)) << '"' << text << '"';
+        } else {
+            ASSERT_EQ(preview.value, expected.value) << '"' << text << '"';
+        }
+    }
+}
+
+void expectSamePreview(const Preview& actual, const Preview& expected, const std::string& text) {
+    ASSERT_EQ(actual.status, expected.status) << '"' << text << '"';
+    ASSERT_EQ(actual.hasValue, expected.hasValue) << '"' << text << '"';
+    ASSERT_EQ(actual.error.error, expected.error.error) << '"' << text << '"';
+    ASSERT_EQ(actual.error.position, expected.error.position) << '"' << text << '"';
+    if (actual.hasValue && !std::isnan(expected.value)) {
+        ASSERT_EQ(actual.value, expected.value) << '"' << text << '"';
+    }
+}
+} // namespace
+
+TEST(IncrementalEvaluatorTest, CompleteExpressions) {
+    for (const char* text : {"42", "1+2*3", "2^3^2", "-2^2", "(1.5 + 2.25) * -3 / (4 - 0.5) ^ 2", "8-2-1", "1."}) {
+        CalculatorCore calc;
+        Preview preview = previewOf(text);
+        EXPECT_EQ(preview.status, Preview::Complete) << text;
+        EXPECT_EQ(preview.value, calc.calculate(text)) << text;
+    }
+}
+
+TEST(IncrementalEvaluatorTest, PartialShowsWhatIsComplete) {
+    Preview preview = previewOf("3+4*");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    ASSERT_TRUE(preview.hasValue);
+    EXPECT_EQ(preview.value, 7);
+
+    preview = previewOf("2*(3+4");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    EXPECT_EQ(preview.value, 14);
+
+    preview = previewOf("2*-(");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    EXPECT_EQ(preview.value, 2);
+
+    for (const char* text : {"(", "-", "((-", "."}) {
+        preview = previewOf(text);
+        EXPECT_EQ(preview.status, Preview::Partial) << text;
+        EXPECT_FALSE(preview.hasValue) << text;
+    }
+
+    EXPECT_EQ(previewOf("").status, Preview::Empty);
+    EXPECT_EQ(previewOf("  +").status, Preview::Empty);
+}
+
+TEST(IncrementalEvaluatorTest, InvalidReportsError) {
+    Preview preview = previewOf("1+$");
+    EXPECT_EQ(preview.status, Preview::Invalid);
+    EXPECT_EQ(preview.error.error, CalcError::InvalidCharacter);
+    EXPECT_EQ(preview.error.position, 2u);
+
+    preview = previewOf("1)");
+    EXPECT_EQ(preview.error.error, CalcError::MismatchedParentheses);
+
+    preview = previewOf("1.2.");
+    EXPECT_EQ(preview.error.error, CalcError::InvalidNumber);
+
+    preview = previewOf("4/(2-2");
+    EXPECT_EQ(preview.status, Preview::Invalid);
+    EXPECT_EQ(preview.error.error, CalcError::DivisionByZero);
+    EXPECT_EQ(preview.error.position, 1u);
+}
+
+TEST(IncrementalEvaluatorTest, PopRestoresPreviousState) {
+    IncrementalEvaluator evaluator;
+    evaluator.push("2*(3+4)");
+    EXPECT_EQ(evaluator.preview().value, 14);
+    evaluator.pop();
+    evaluator.pop();
+    EXPECT_EQ(evaluator.text(), "2*(3+");
+    EXPECT_EQ(evaluator.preview().status, Preview::Partial);
+    evaluator.push("5)");
+    EXPECT_EQ(evaluator.preview().value, 16);
+
+    evaluator.push("$");
+    EXPECT_EQ(evaluator.preview().status, Preview::Invalid);
+    evaluator.pop();
+    EXPECT_EQ(evaluator.preview().value, 16);
+
+    evaluator.assign("2*(3+5)^2");
+    EXPECT_EQ(evaluator.preview().value, 128);
+    evaluator.assign("7");
+    EXPECT_EQ(evaluator.preview().value, 7);
+
+    evaluator.clear();
+    evaluator.pop();
+    EXPECT_EQ(evaluator.preview().status, Preview::Empty);
+}
+
+TEST(IncrementalEvaluatorTest, EveryPrefixMatchesPipeline) {
+    static constexpr char kAlphabet[] = "0123456789.+-*/^()  x$";
+    std::mt19937 rng(4321);
+    std::uniform_int_distribution<size_t> length(0, 16);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+
+    CalculatorCore calc;
+    IncrementalEvaluator evaluator;
+    for (int i = 0; i < 20000; i++) {
+        evaluator.clear();
+        for (size_t n = length(rng); n > 0; n--) {
+            evaluator.push(std::string(1, kAlphabet[pick(rng)]));
+            expectConsistent(calc, evaluator);
+        }
+    }
+}
+
+TEST(IncrementalEvaluatorTest, Calls) {
+    Preview preview = previewOf("max(1, 2) * sqrt(16)");
+    EXPECT_EQ(preview.status, Preview::Complete);
+    EXPECT_EQ(preview.value, 8);
+
+    // An open call is folded once all of its arguments are there
+    preview = previewOf("2 * hypot(3, 4");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    EXPECT_EQ(preview.value, 10);
+    preview = previewOf("2 + max(3,");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    EXPECT_EQ(preview.value, 2);
+    preview = previewOf("max(3");
+    EXPECT_EQ(preview.status, Preview::Partial);
+    EXPECT_FALSE(preview.hasValue);
+
+    preview = previewOf("foo(");
+    EXPECT_EQ(preview.error.error, CalcError::UnknownFunction);
+    EXPECT_EQ(preview.error.position, 0u);
+    EXPECT_EQ(previewOf("sqrt(1,").error.error, CalcError::WrongArgumentCount);
+    EXPECT_EQ(previewOf("max(1)").error.error, CalcError::WrongArgumentCount);
+    EXPECT_EQ(previewOf("(1,").error.error, CalcError::WrongArgumentCount);
+
+    // Registered functions resolve through the table the evaluator was given
+    FunctionTable functions;
+    functions.add("twice", 1, [](const double* a) { return 2 * a[0]; });
+    IncrementalEvaluator evaluator(functions);
+    evaluator.push("twice(max(1, 4))");
+    EXPECT_EQ(evaluator.preview().value, 8);
+}
+
+TEST(IncrementalEvaluatorTest, CallPrefixesMatchPipeline) {
+    static constexpr const char* kTokens[] = {"1", "2", ".",    "+",     "-",     "*",      "/",  "^", "(",
+                                              ")", ",", "x",    "sqrt",  "max(",  "sqrt(", "atan2(", "x(", " "};
+    std::mt19937 rng(8765);
+    std::uniform_int_distribution<size_t> length(0, 10);
+    std::uniform_int_distribution<size_t> pick(0, std::size(kTokens) - 1);
+
+    CalculatorCore calc;
+    IncrementalEvaluator evaluator;
+    for (int i = 0; i < 20000; i++) {
+        evaluator.clear();
+        for (size_t n = length(rng); n > 0; n--) {
+            for (const char* c = kTokens[pick(rng)]; *c; c++) {
+                evaluator.push(std::string(1, *c));
+                expectConsistent(calc, evaluator);
+            }
+        }
+        // Backspacing through the calls must restore every earlier state
+        while (!evaluator.text().empty()) {
+            evaluator.pop();
+            expectSamePreview(evaluator.preview(), previewOf(evaluator.text()), evaluator.text());
+        }
+    }
+}
+
+TEST(IncrementalEvaluatorTest, RandomEditsMatchFreshEvaluation) {
+    static constexpr char kAlphabet[] = "0123456789.+-*/^()";
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+    std::bernoulli_distribution backspace(0.3);
+
+    IncrementalEvaluator evaluator;
+    for (int i = 0; i < 50000; i++) {
+        if (backspace(rng) || evaluator.text().size() >= 24) {
+            evaluator.pop();
+        } else {
+            evaluator.push(std::string(1, kAlphabet[pick(rng)]));
+        }
+        expectSamePreview(evaluator.preview(), previewOf(evaluator.text()), evaluator.text());
+    }
+}
+
+TEST(IncrementalEvaluatorTest, LongBufferStaysIncremental) {
+    CalculatorCore calc;
+    IncrementalEvaluator evaluator;
+    std::string text;
+    for (int i = 0; i < 10000; i++) {
+        evaluator.push(i == 0 ? "1" : "+1");
+        ASSERT_EQ(evaluator.preview().value, i + 1);
+        text += i == 0 ? "1" : "+1";
+    }
+    EXPECT_EQ(evaluator.preview().value, calc.calculate(text));
+}
@@ -0,0 +1,100 @@
+#include "calculator/power_kernels.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+// Maps doubles onto integers so that adjacent representable values differ by one
+int64_t orderedBits(double value) {
+    int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits;
+}
+
+uint64_t ulpDistance(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b) ? 0 : std::numeric_limits<uint64_t>::max();
+    }
+    if (a == b) {
+        return 0; // Also equates +0 and -0
+    }
+    int64_t x = orderedBits(a);
+    int64_t y = orderedBits(b);
+    return x > y ? static_cast<uint64_t>(x) - static_cast<uint64_t>(y) : static_cast<uint64_t>(y) - static_cast<uint64_t>(x);
+}
+
+// Random bases spanning the whole exponent range, both signs, plus special values
+std::vector<double> sampleBases(bool includeNegative) {
+    std::vector<double> bases = {0.0,  -0.0, 1.0, -1.0, 2.0, 0.5, std::numeric_limits<double>::infinity(),
+                                 -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(),
+                                 std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::min(),
+                                 std::numeric_limits<double>::max()};
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> mantissa(0.5, 1.0);
+    std::uniform_int_distribution<int> exponent(-1074, 1024);
+    for (int i = 0; i < 100000; i++) {
+        double base = std::ldexp(mantissa(rng), exponent(rng));
+        bases.push_back(includeNegative && (rng() & 1) ? -base : base);
+    }
+    return bases;
+}
+
+uint64_t maxUlpError(double exponent, power_kernels::Accuracy accuracy) {
+    uint64_t worst = 0;
+    for (double base : sampleBases(true)) {
+        double expected = std::pow(base, exponent);
+        double actual = power_kernels::pow(base, exponent, accuracy);
+        // Specials must match exactly, including the sign of zero
+        if (expected == 0.0 || std::isinf(expected)) {
+            EXPECT_EQ(std::signbit(actual), std::signbit(expected)) << base << "^" << exponent;
+        }
+        worst = std::max(worst, ulpDistance(actual, expected));
+    }
+    return worst;
+}
+} // namespace
+
+TEST(PowerKernelsTest, FaithfulKernelsWithinOneUlp) {
+    for (double exponent : {0.0, 1.0, 2.0, 3.0, 0.5, -1.0}) {
+        EXPECT_LE(maxUlpError(exponent, power_kernels::Accuracy::Faithful), 1u) << "exponent " << exponent;
+    }
+}
+
+TEST(PowerKernelsTest, PowersOfTwoAreExact) {
+    for (int exponent = -1100; exponent <= 1100; exponent++) {
+        EXPECT_EQ(ulpDistance(power_kernels::pow(2.0, exponent), std::pow(2.0, exponent)), 0u) << exponent;
+    }
+}
+
+TEST(PowerKernelsTest, FastIntegerPowersWithinBound) {
+    for (int64_t exponent = -power_kernels::kMaxSquaringExponent; exponent <= power_kernels::kMaxSquaringExponent;
+         exponent++) {
+        // The bound only holds where the result is normal; subnormal results lose precision in any case
+        uint64_t worst = 0;
+        for (double base : sampleBases(true)) {
+            double expected = std::pow(base, static_cast<double>(exponent));
+            if (!std::isnormal(expected)) {
+                continue;
+            }
+            double actual = power_kernels::integerPower(base, exponent);
+            worst = std::max(worst, ulpDistance(actual, expected));
+        }
+        EXPECT_LE(worst, static_cast<uint64_t>(std::abs(exponent) + 1)) << "exponent " << exponent;
+    }
+}
+
+TEST(PowerKernelsTest, FallsBackToStdPow) {
+    for (double exponent : {2.5, -0.5, 1e300, 7.0}) {
+        for (double base : {0.3, 1.7, 123.0}) {
+            EXPECT_EQ(power_kernels::pow(base, exponent, power_kernels::Accuracy::Faithful), std::pow(base, exponent));
+        }
+    }
+    EXPECT_TRUE(std::isnan(power_kernels::pow(-8.0, 1.0 / 3.0)));
+    EXPECT_EQ(power_kernels::pow(std::numeric_limits<double>::quiet_NaN(), 0.0), 1.0);
+}
@@ -0,0 +1,103 @@
+#include "calculator/calculator_core.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+class PrattEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override { pratt.setEngine(CalculatorCore::Engine::Pratt); }
+
+    void expectSameResult(const std::string& expression) {
+        CalcResult expected = reference.tryCalculate(expression);
+        CalcResult actual = pratt.tryCalculate(expression);
+        ASSERT_EQ(actual.error, expected.error) << '"' << expression << '"';
+        ASSERT_EQ(actual.position, expected.position) << '"' << expression << '"';
+        if (expected.ok()) {
+            if (std::isnan(expected.value)) {
+                ASSERT_TRUE(std::isnan(actual.value)) << '"' << expression << '"';
+            } else {
+                ASSERT_EQ(actual.value, expected.value) << '"' << expression << '"';
+            }
+        }
+    }
+
+    CalculatorCore reference;
+    CalculatorCore pratt;
+};
+
+TEST_F(PrattEngineTest, EngineSelection) {
+    EXPECT_EQ(reference.engine(), CalculatorCore::Engine::ShuntingYard);
+    EXPECT_EQ(pratt.engine(), CalculatorCore::Engine::Pratt);
+    EXPECT_DOUBLE_EQ(pratt.calculate("(1.5 + 2.25) * -3 / (4 - 0.5) ^ 2 + 10 - 7 * 8"), -46.918367346938776);
+}
+
+TEST_F(PrattEngineTest, PowerIsRightAssociative) {
+    for (CalculatorCore* calc : {&reference, &pratt}) {
+        EXPECT_EQ(calc->calculate("2^3^2"), 512);
+        EXPECT_EQ(calc->calculate("(2^3)^2"), 64);
+        EXPECT_EQ(calc->calculate("-2^2"), -4);
+        EXPECT_EQ(calc->calculate("2^-1"), 0.5);
+        EXPECT_EQ(calc->calculate("2^-1^2"), 0.5);
+        EXPECT_EQ(calc->calculate("-1+-1"), -2);
+        EXPECT_EQ(calc->calculate("8-2-1"), 5);
+        EXPECT_EQ(calc->calculate("8/2/2"), 2);
+    }
+    EXPECT_EQ(reference.compile("2^x^2").evaluate({3}), 512);
+}
+
+TEST_F(PrattEngineTest, ErrorsMatchPipeline) {
+    // Lexical errors win over parenthesis errors, which win over evaluation errors
+    for (const char* expression : {"", "   ", "+", "-", "1+", "()", "(1))", "1)+(2", "((1)", "1+2)+$", "1/0+$",
+                                   "1/0+(2", "1/0+x", "x+1/0", "1 2", "2(3)", "1.2.3", "*1", "1+*2", ")", "(",
+                                   "1/(2-2)", "-(-(-1))", "1++2", "1+-+-2", "abc def", "max(1,2)", "max(1)",
+                                   "max(1,2,3", "(1,2", "1,2)", "max((1,2),3", "foo(1", "sqrt (1)", "max(,",
+                                   "max(1,2)$", "sqrt(1/0,", "sqrt(x)", ",", "max(1,2))", "min(1/0, x)"}) {
+        expectSameResult(expression);
+    }
+}
+
+TEST_F(PrattEngineTest, RandomExpressionsMatchPipeline) {
+    static constexpr char kAlphabet[] = "0123456789.+-*/^()  x$";
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> length(0, 16);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+
+    std::string expression;
+    for (int i = 0; i < 100000; i++) {
+        expression.clear();
+        for (size_t n = length(rng); n > 0; n--) {
+            expression += kAlphabet[pick(rng)];
+        }
+        expectSameResult(expression);
+    }
+}
+
+TEST_F(PrattEngineTest, RandomCallsMatchPipeline) {
+    static constexpr const char* kTokens[] = {"1", "2", ".",    "+",     "-",     "*",      "/",  "^", "(", ")",
+                                              ",", "x", "sqrt", "max(", "sqrt(", "atan2(", "x(", " ", "$"};
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<size_t> length(0, 12);
+    std::uniform_int_distribution<size_t> pick(0, std::size(kTokens) - 1);
+
+    std::string expression;
+    for (int i = 0; i < 100000; i++) {
+        expression.clear();
+        for (size_t n = length(rng); n > 0; n--) {
+            expression += kTokens[pick(rng)];
+        }
+        expectSameResult(expression);
+    }
+}
+
+TEST_F(PrattEngineTest, DeepNestingFallsBack) {
+    std::string expression(100000, '(');
+    expression += "1";
+    expression.append(100000, ')');
+    EXPECT_EQ(pratt.calculate(expression), 1);
+
+    expression.pop_back();
+    expectSameResult(expression);
+}
@@ -0,0 +1,106 @@
+#include "calculator/calculator_core.hpp"
+#include "calculator/result_cache.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class ResultCacheTest : public ::testing::Test {
+protected:
+    CalculatorCore calc;
+};
+
+TEST_F(ResultCacheTest, Normalize) {
+    std::string key;
+    ResultCache::normalize("  1 +  2 * ( x )\t", key);
+    EXPECT_EQ(key, "1+2*(x)");
+    ResultCache::normalize("1 2", key);
+    EXPECT_EQ(key, "1 2");
+    ResultCache::normalize("12", key);
+    EXPECT_EQ(key, "12");
+    // A space between a name and '(' decides between a variable and a call
+    ResultCache::normalize("max (1, 2)", key);
+    EXPECT_EQ(key, "max (1,2)");
+    ResultCache::normalize(" max( 1 , 2 )", key);
+    EXPECT_EQ(key, "max(1,2)");
+}
+
+TEST_F(ResultCacheTest, HitsShareNormalizedKeys) {
+    ResultCache cache;
+    EXPECT_EQ(cache.calculate(calc, "1+2"), 3);
+    EXPECT_EQ(cache.calculate(calc, " 1 + 2 "), 3);
+    EXPECT_THROW(cache.calculate(calc, "1 2"), std::runtime_error);
+    EXPECT_EQ(cache.calculate(calc, "12"), 12);
+    EXPECT_EQ(cache.stats().hits, 1u);
+}
+
+TEST_F(ResultCacheTest, CachesValuesAndErrors) {
+    ResultCache cache;
+    EXPECT_EQ(cache.calculate(calc, "2*3"), 6);
+    EXPECT_EQ(cache.calculate(calc, "2 * 3"), 6);
+    for (int i = 0; i < 3; i++) {
+        try {
+            cache.calculate(calc, "1/0");
+            FAIL() << "expected an exception";
+        } catch (const std::runtime_error& e) {
+            EXPECT_STREQ(e.what(), "Division by zero");
+        }
+    }
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST_F(ResultCacheTest, CancellationIsNotCached) {
+    ResultCache cache;
+    std::atomic<bool> cancel{true};
+    calc.setCancellationFlag(&cancel);
+    EXPECT_THROW(cache.calculate(calc, "1 + 2"), std::runtime_error);
+    EXPECT_EQ(cache.size(), 0u);
+
+    cancel.store(false);
+    EXPECT_EQ(cache.calculate(calc, "1 + 2"), 3);
+    calc.setCancellationFlag(nullptr);
+}
+
+TEST_F(ResultCacheTest, EvictsLeastRecentlyUsed) {
+    ResultCache cache(2, 1);
+    cache.calculate(calc, "1");
+    cache.calculate(calc, "2");
+    cache.calculate(calc, "1"); // "2" is now least recently used
+    cache.calculate(calc, "3");
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+
+    cache.calculate(calc, "1");
+    EXPECT_EQ(cache.stats().hits, 2u);
+    cache.calculate(calc, "2");
+    EXPECT_EQ(cache.stats().misses, 4u);
+}
+
+TEST_F(ResultCacheTest, ConcurrentCallers) {
+    ResultCache cache(64, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache] {
+            CalculatorCore local;
+            for (int i = 0; i < 2000; i++) {
+                int n = i % 100;
+                ASSERT_EQ(cache.calculate(local, std::to_string(n) + " * 2"), n * 2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 8000u);
+    EXPECT_LE(cache.size(), 64u);
+}